@@ -0,0 +1,1087 @@
+// Headless benchmark for the CPU hot paths: terrain generation, saving and
+// loading, chunk meshing, raycasts, box moves, block edits, relighting, water
+// ticks and chunk culling.
+// Needs no window. Prints one JSON object (or CSV with --csv) to stdout so
+// runs can be diffed across commits; progress goes to stderr.
+//
+// The raycast is also checked against the original brute-force version; the
+// exit code is 2 if they disagree, or if a box move ends inside a block.
+//
+//   ./mini_minecraft_bench [--reps N] [--rays N] [--check-rays N]
+//                          [--cameras N] [--edits N] [--seed N]
+//                          [--threads N] [--csv]
+//
+// --threads sets the terrain generation workers (default: one per core), so
+// generate can be compared across thread counts.
+
+#include "math_utils.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+#define EDIT_BATCH 256 // Edits are too quick to time one by one
+#define FILL_BOX_SIZE 100 // Bulk fill edge, 1M blocks
+#define WATER_TANK_SIZE 48 // Flooded cavern edge
+#define WATER_MAX_TICKS 500
+
+// Everything but culling works on the middle of the island, loaded once at
+// the largest render distance: [AREA_MIN, AREA_MAX) blocks on x and z
+#define AREA_MIN (ISLAND_SIZE / 4)
+#define AREA_MAX (ISLAND_SIZE * 3 / 4)
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedNs(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+// Small deterministic RNG so every run benchmarks the same rays and edits
+struct BenchRng {
+  uint64_t state;
+
+  uint32_t Next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (uint32_t)(state >> 32);
+  }
+  int Range(int lo, int hi) { return lo + (int)(Next() % (hi - lo + 1)); }
+  float Unit() { return (Next() >> 8) / 16777216.0f; } // [0, 1)
+};
+
+// One timed sample: `ops` operations that moved `bytes` bytes (0 = n/a)
+struct BenchSample {
+  double ns;
+  double ops;
+  double bytes;
+};
+
+// Memory once the area is loaded from the save, one way or the other
+struct LoadMemory {
+  size_t voxelBytes; // World::GetVoxelMemoryUsage, heap only
+  size_t rssBytes;   // Whole process, mapped pages touched included
+};
+
+// Faces one meshing mode produces over the whole area. mesh_counts reports
+// both modes and naive_per_greedy, which is about 2.1 on the default area,
+// short of the 5x aimed for: greedy only joins faces of the same type, light
+// and corner occlusion, and even joining every coplanar face would give about
+// 3.1 here, as leaves, caves and one-block steps leave small flat patches.
+struct MeshCounts {
+  size_t vertices; // Four per quad
+  size_t quads;
+};
+
+struct BenchStats {
+  double min, p50, p90, p99, max, mean;
+};
+
+struct BenchSeries {
+  std::string name;
+  std::vector<BenchSample> samples;
+  bool hasBytes;
+};
+
+static BenchStats ComputeStats(std::vector<double> values) {
+  BenchStats s = {0};
+  if (values.empty())
+    return s;
+  std::sort(values.begin(), values.end());
+  double sum = 0;
+  for (double v : values)
+    sum += v;
+  // Nearest-rank percentiles
+  auto rank = [&](double p) {
+    size_t i = (size_t)(p * values.size());
+    return values[i < values.size() ? i : values.size() - 1];
+  };
+  s.min = values.front();
+  s.p50 = rank(0.50);
+  s.p90 = rank(0.90);
+  s.p99 = rank(0.99);
+  s.max = values.back();
+  s.mean = sum / values.size();
+  return s;
+}
+
+static BenchStats NsPerOp(const BenchSeries &series) {
+  std::vector<double> values;
+  for (const BenchSample &s : series.samples)
+    values.push_back(s.ns / s.ops);
+  return ComputeStats(values);
+}
+
+static BenchStats MegabytesPerSecond(const BenchSeries &series) {
+  std::vector<double> values;
+  for (const BenchSample &s : series.samples)
+    values.push_back(s.bytes / s.ns * 1000.0); // bytes/ns = GB/s
+  return ComputeStats(values);
+}
+
+static double TotalOps(const BenchSeries &series) {
+  double ops = 0;
+  for (const BenchSample &s : series.samples)
+    ops += s.ops;
+  return ops;
+}
+
+static void PrintStatsJson(const char *key, const BenchStats &s) {
+  printf("\"%s\": {\"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, "
+         "\"p99\": %.1f, \"max\": %.1f, \"mean\": %.1f}",
+         key, s.min, s.p50, s.p90, s.p99, s.max, s.mean);
+}
+
+static void PrintJson(const std::vector<BenchSeries> &results, int reps,
+                      int rays, int edits, unsigned seed, int threads,
+                      size_t voxelBytes, size_t lightBytes,
+                      const LoadMemory &readMemory,
+                      const LoadMemory &mappedMemory, double candidates,
+                      double frustumOnly, double visible,
+                      const MeshCounts &greedy, const MeshCounts &naive) {
+  printf("{\n  \"config\": {\"reps\": %d, \"rays\": %d, \"edits\": %d, "
+         "\"seed\": %u, \"threads\": %d, \"area\": [%d, %d], "
+         "\"render_distance\": %d},\n",
+         reps, rays, edits, seed, threads, AREA_MIN, AREA_MAX,
+         MAX_RENDER_DISTANCE);
+  printf("  \"voxel_bytes\": %zu,\n", voxelBytes);
+  printf("  \"light_bytes\": %zu,\n", lightBytes);
+  printf("  \"load_memory\": {\"read\": {\"voxel_bytes\": %zu, "
+         "\"rss_bytes\": %zu}, \"mapped\": {\"voxel_bytes\": %zu, "
+         "\"rss_bytes\": %zu}},\n",
+         readMemory.voxelBytes, readMemory.rssBytes, mappedMemory.voxelBytes,
+         mappedMemory.rssBytes);
+  printf("  \"chunks_per_camera\": {\"meshed\": %.1f, \"in_frustum\": %.1f, "
+         "\"drawn\": %.1f},\n",
+         candidates, frustumOnly, visible);
+  printf("  \"mesh_counts\": {\"greedy\": {\"vertices\": %zu, \"quads\": %zu}, "
+         "\"naive\": {\"vertices\": %zu, \"quads\": %zu}, "
+         "\"naive_per_greedy\": %.2f},\n",
+         greedy.vertices, greedy.quads, naive.vertices, naive.quads,
+         greedy.vertices ? (double)naive.vertices / greedy.vertices : 0.0);
+  printf("  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchSeries &r = results[i];
+    printf("    {\"name\": \"%s\", \"samples\": %zu, \"ops\": %.0f, ",
+           r.name.c_str(), r.samples.size(), TotalOps(r));
+    PrintStatsJson("ns_per_op", NsPerOp(r));
+    if (r.hasBytes) {
+      printf(", ");
+      PrintStatsJson("mb_per_s", MegabytesPerSecond(r));
+    }
+    printf("}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+static void PrintCsv(const std::vector<BenchSeries> &results) {
+  printf("name,samples,ops,stat,ns_per_op,mb_per_s\n");
+  const char *stats[] = {"min", "p50", "p90", "p99", "max", "mean"};
+  for (const BenchSeries &r : results) {
+    BenchStats ns = NsPerOp(r);
+    BenchStats mb = MegabytesPerSecond(r);
+    double nsValues[] = {ns.min, ns.p50, ns.p90, ns.p99, ns.max, ns.mean};
+    double mbValues[] = {mb.min, mb.p50, mb.p90, mb.p99, mb.max, mb.mean};
+    for (int i = 0; i < 6; i++) {
+      printf("%s,%zu,%.0f,%s,%.1f,", r.name.c_str(), r.samples.size(),
+             TotalOps(r), stats[i], nsValues[i]);
+      if (r.hasBytes)
+        printf("%.1f", mbValues[i]);
+      printf("\n");
+    }
+  }
+}
+
+// One sample per rep: reset, then generate and compact every column around
+// the middle of the island at the largest render distance, trees included,
+// on the given number of workers. Ops are columns.
+static BenchSeries BenchGenerate(World *world, int reps, unsigned seed,
+                                 int threads) {
+  BenchSeries series = {"generate", {}, true};
+  Vector3 center = {ISLAND_SIZE / 2.0f, 80.0f, ISLAND_SIZE / 2.0f};
+  for (int r = 0; r < reps; r++) {
+    fprintf(stderr, "generate %d/%d\n", r + 1, reps);
+    if (r > 0)
+      world->Unload();
+    world->Init(true, seed, threads);
+    world->SetRenderDistance(MAX_RENDER_DISTANCE);
+    Clock::time_point start = Clock::now();
+    world->StreamColumns(center);
+    double columns = world->GetLoadedColumnCount();
+    double cells = columns * CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT;
+    series.samples.push_back({ElapsedNs(start), columns, cells});
+  }
+  return series;
+}
+
+// Resident set size of the process, 0 where it can't be read
+static size_t ResidentBytes() {
+#ifdef __APPLE__
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info,
+                &count) != KERN_SUCCESS)
+    return 0;
+  return (size_t)info.resident_size;
+#else
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (!f)
+    return 0;
+  long pages = 0, resident = 0;
+  int n = fscanf(f, "%ld %ld", &pages, &resident);
+  fclose(f);
+  return n == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+// Unloads the world, then opens the save (read-only: memory-mapped, lazy
+// sections) and streams the area around the middle of the island in.
+// Returns the nanoseconds taken by the open and the streaming.
+static double LoadFromSave(World *world, unsigned seed, int threads,
+                           const char *directory, bool readOnly) {
+  Vector3 center = {ISLAND_SIZE / 2.0f, 80.0f, ISLAND_SIZE / 2.0f};
+  world->Unload();
+  world->Init(true, seed, threads);
+  world->SetRenderDistance(MAX_RENDER_DISTANCE);
+  Clock::time_point start = Clock::now();
+  world->OpenSave(directory, readOnly);
+  world->StreamColumns(center);
+  return ElapsedNs(start);
+}
+
+// Saves the same area as generate into a scratch directory (one sample, ops
+// are columns written, throughput is file bytes), then loads it back once per
+// rep, from the open to the last column landing: load_mapped with the save
+// memory-mapped read only, then load reading it. Ops are columns read.
+// Leaves the world loaded (and writable) from the save.
+static void BenchSaveLoad(World *world, int reps, unsigned seed, int threads,
+                          const char *directory,
+                          std::vector<BenchSeries> &results,
+                          LoadMemory *readMemory, LoadMemory *mappedMemory) {
+  Vector3 center = {ISLAND_SIZE / 2.0f, 80.0f, ISLAND_SIZE / 2.0f};
+  BenchSeries save = {"save", {}, true};
+  BenchSeries load = {"load", {}, true};
+  BenchSeries loadMapped = {"load_mapped", {}, true};
+  fprintf(stderr, "save\n");
+  world->Unload();
+  world->Init(true, seed, threads);
+  world->SetRenderDistance(MAX_RENDER_DISTANCE);
+  world->OpenSave(directory);
+  world->StreamColumns(center);
+  double columns = world->GetGeneratedColumnCount();
+  Clock::time_point start = Clock::now();
+  world->Unload(); // Writes every finished column
+  double bytes = 0;
+  for (const auto &file : std::filesystem::directory_iterator(directory))
+    bytes += (double)std::filesystem::file_size(file.path());
+  save.samples.push_back({ElapsedNs(start), columns, bytes});
+
+  for (int mapped = 1; mapped >= 0; mapped--) {
+    BenchSeries &series = mapped ? loadMapped : load;
+    for (int r = 0; r < reps; r++) {
+      fprintf(stderr, "%s %d/%d\n", series.name.c_str(), r + 1, reps);
+      double ns = LoadFromSave(world, seed, threads, directory, mapped != 0);
+      double read = world->GetReadColumnCount();
+      double cells = read * CHUNK_SIZE * CHUNK_SIZE * WORLD_HEIGHT;
+      series.samples.push_back({ns, read, cells});
+    }
+    LoadMemory &memory = mapped ? *mappedMemory : *readMemory;
+    memory.voxelBytes = world->GetVoxelMemoryUsage();
+    memory.rssBytes = ResidentBytes();
+    fprintf(stderr, "%s: voxels %.1f MB, rss %.1f MB\n", series.name.c_str(),
+            memory.voxelBytes / 1048576.0, memory.rssBytes / 1048576.0);
+  }
+  results.push_back(save);
+  results.push_back(load);
+  results.push_back(loadMapped);
+}
+
+// Encodes the sections of a strip of columns through the middle of the area
+// and decodes them back, one sample per section, with its cells as
+// throughput. Each stream then gets a type past the last BlockType in its
+// first run, which Decode and EncodedSize must both reject (a column record
+// with it regenerates instead of loading): `accepted` counts the ones that
+// got through either.
+static BenchSeries BenchDecodeSection(World *world, int *accepted) {
+  BenchSeries series = {"decode_section", {}, true};
+  fprintf(stderr, "decode_section\n");
+  ChunkSection section, decoded;
+  std::vector<uint8_t> stream;
+  *accepted = 0;
+  int cz = ISLAND_SIZE / 2 / CHUNK_SIZE;
+  for (int cx = AREA_MIN / CHUNK_SIZE; cx < AREA_MAX / CHUNK_SIZE; cx++) {
+    for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+      for (int i = 0; i < CHUNK_VOLUME; i++) {
+        int lx = i % CHUNK_SIZE, lz = i / CHUNK_SIZE % CHUNK_SIZE;
+        int ly = i / (CHUNK_SIZE * CHUNK_SIZE);
+        section.Set(lx, ly, lz,
+                    world->GetBlock(cx * CHUNK_SIZE + lx, cy * CHUNK_SIZE + ly,
+                                    cz * CHUNK_SIZE + lz)
+                        .type);
+      }
+      stream.clear();
+      section.Encode(stream);
+      Clock::time_point start = Clock::now();
+      decoded.Decode(stream.data(), stream.size());
+      series.samples.push_back({ElapsedNs(start), 1, (double)CHUNK_VOLUME});
+
+      int runs;
+      stream[0] = BLOCK_TYPE_COUNT;
+      if (decoded.Decode(stream.data(), stream.size()) != 0 ||
+          ChunkSection::EncodedSize(stream.data(), stream.size(), runs) != 0)
+        (*accepted)++;
+    }
+  }
+  return series;
+}
+
+// One sample per rep: one block edit in every column of the area, then an
+// autosave. autosave_snapshot is the copy on the main thread, autosave_write
+// the I/O thread's encode, region write and fsync; both per column, the
+// latter with the region bytes written as throughput. autosave_one_column
+// then edits a single column per autosave, the usual case while playing.
+static void BenchAutosave(World *world, int reps,
+                          std::vector<BenchSeries> &results) {
+  BenchSeries snapshot = {"autosave_snapshot", {}, false};
+  BenchSeries write = {"autosave_write", {}, true};
+  for (int r = 0; r < reps; r++) {
+    fprintf(stderr, "autosave %d/%d\n", r + 1, reps);
+    for (int x = AREA_MIN; x < AREA_MAX; x += CHUNK_SIZE)
+      for (int z = AREA_MIN; z < AREA_MAX; z += CHUNK_SIZE)
+        world->SetBlock(x, WORLD_HEIGHT - 1, z, r % 2 == 0, BLOCK_STONE);
+    world->Autosave();
+    world->WaitForAutosave();
+    SaveStats stats = world->GetLastSaveStats();
+    snapshot.samples.push_back(
+        {stats.snapshotMs * 1000000.0, (double)stats.columns, 0});
+    write.samples.push_back({stats.writeMs * 1000000.0, (double)stats.columns,
+                             (double)stats.bytes});
+  }
+  BenchSeries single = {"autosave_one_column", {}, true};
+  for (int r = 0; r < reps * 10; r++) {
+    world->SetBlock(AREA_MIN + r % CHUNK_SIZE, WORLD_HEIGHT - 1, AREA_MIN,
+                    true, BLOCK_STONE);
+    world->Autosave();
+    world->WaitForAutosave();
+    SaveStats stats = world->GetLastSaveStats();
+    single.samples.push_back({stats.writeMs * 1000000.0, (double)stats.columns,
+                              (double)stats.bytes});
+  }
+  results.push_back(snapshot);
+  results.push_back(write);
+  results.push_back(single);
+}
+
+// Snapshot + mesh every non-empty chunk on one thread, one sample per chunk.
+// Throughput counts the chunk's cells (one byte each) so the two modes compare
+// directly. Chunks without faces (all air or buried) are left out.
+static BenchSeries BenchMeshing(World *world, MeshingMode mode,
+                                MeshCounts *counts) {
+  BenchSeries series = {mode == MESHING_GREEDY ? "mesh_greedy" : "mesh_naive",
+                        {},
+                        true};
+  fprintf(stderr, "%s\n", series.name.c_str());
+  world->SetMeshingMode(mode);
+  ChunkSnapshot *snapshot = new ChunkSnapshot();
+  ChunkMeshData mesh;
+  for (int cx = AREA_MIN / CHUNK_SIZE; cx < AREA_MAX / CHUNK_SIZE; cx++) {
+    for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+      for (int cz = AREA_MIN / CHUNK_SIZE; cz < AREA_MAX / CHUNK_SIZE; cz++) {
+        Clock::time_point start = Clock::now();
+        world->BuildChunkMeshNow(cx, cy, cz, *snapshot, mesh);
+        double ns = ElapsedNs(start);
+        if (mesh.vertexCount > 0)
+          series.samples.push_back({ns, 1, (double)CHUNK_VOLUME});
+        counts->vertices += mesh.vertexCount;
+        counts->quads += mesh.GetQuadCount();
+      }
+    }
+  }
+  delete snapshot;
+  return series;
+}
+
+// Worst case found for the visibility flood fill: air and stone repeating
+// every 4x3x3 cells keep about 1100 row seeds waiting at once, more than the
+// 1024 its stack once held. By x, then y, then z; '#' is stone.
+static const char *const FLOOD_PATTERN[4][3] = {{"#..", "...", "###"},
+                                                {".##", "...", "..."},
+                                                {"...", "###", "..."},
+                                                {"##.", "...", "..."}};
+
+// The visibility graph of an air/stone chunk, flooding one cell at a time
+static uint16_t ReferenceVisibility(const ChunkSnapshot &snapshot) {
+  static const int STEP[CHUNK_FACE_COUNT][3] = {
+      {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+  std::vector<bool> seen(CHUNK_VOLUME, false);
+  std::vector<int> queue;
+  uint16_t visibility = 0;
+  for (int start = 0; start < CHUNK_VOLUME; start++) {
+    int sx = start % CHUNK_SIZE, sz = start / CHUNK_SIZE % CHUNK_SIZE;
+    int sy = start / (CHUNK_SIZE * CHUNK_SIZE);
+    if (seen[start] || snapshot.Get(sx, sy, sz) != BLOCK_AIR)
+      continue;
+    seen[start] = true;
+    queue.assign(1, start);
+    int faces = 0;
+    for (size_t q = 0; q < queue.size(); q++) {
+      int p[3] = {queue[q] % CHUNK_SIZE,
+                  queue[q] / (CHUNK_SIZE * CHUNK_SIZE),
+                  queue[q] / CHUNK_SIZE % CHUNK_SIZE};
+      for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+        int x = p[0] + STEP[face][0], y = p[1] + STEP[face][1];
+        int z = p[2] + STEP[face][2];
+        if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_SIZE || z < 0 ||
+            z >= CHUNK_SIZE) {
+          faces |= 1 << face;
+          continue;
+        }
+        int n = (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+        if (!seen[n] && snapshot.Get(x, y, z) == BLOCK_AIR) {
+          seen[n] = true;
+          queue.push_back(n);
+        }
+      }
+    }
+    for (int a = 0; a < CHUNK_FACE_COUNT; a++)
+      for (int b = a + 1; b < CHUNK_FACE_COUNT; b++)
+        if ((faces >> a & 1) && (faces >> b & 1))
+          visibility |= ChunkFacePairBit(a, b);
+  }
+  return visibility;
+}
+
+// Meshes the flood fill's worst case once per rep and checks its visibility
+// graph against the cell by cell fill
+static BenchSeries BenchMeshFloodWorst(int reps, int *mismatches) {
+  BenchSeries series = {"mesh_flood_worst", {}, true};
+  fprintf(stderr, "mesh_flood_worst\n");
+  ChunkSnapshot *snapshot = new ChunkSnapshot();
+  for (int ly = -1; ly <= CHUNK_SIZE; ly++)
+    for (int lz = -1; lz <= CHUNK_SIZE; lz++)
+      for (int lx = -1; lx <= CHUNK_SIZE; lx++)
+        snapshot->cells[ChunkSnapshot::Index(lx, ly, lz)] =
+            FLOOD_PATTERN[(lx + 4) % 4][(ly + 3) % 3][(lz + 3) % 3] == '#'
+                ? BLOCK_STONE
+                : BLOCK_AIR;
+  uint16_t expected = ReferenceVisibility(*snapshot);
+  ChunkMeshData mesh;
+  *mismatches = 0;
+  for (int r = 0; r < reps; r++) {
+    Clock::time_point start = Clock::now();
+    BuildChunkMesh(*snapshot, MESHING_NAIVE, mesh);
+    series.samples.push_back({ElapsedNs(start), 1, (double)CHUNK_VOLUME});
+    if (mesh.visibility != expected)
+      (*mismatches)++;
+  }
+  delete snapshot;
+  return series;
+}
+
+// Highest solid block in a column, or -1
+static int SurfaceHeight(World *world, int x, int z) {
+  for (int y = WORLD_HEIGHT - 1; y >= 0; y--)
+    if (world->GetBlock(x, y, z).IsActive())
+      return y;
+  return -1;
+}
+
+// Rays from eye height above random surface points in any direction
+static std::vector<Ray> MakeRays(World *world, int count, BenchRng &rng) {
+  std::vector<Ray> rays(count);
+  for (Ray &ray : rays) {
+    int x = rng.Range(AREA_MIN, AREA_MAX - 1);
+    int z = rng.Range(AREA_MIN, AREA_MAX - 1);
+    ray.position = {x + rng.Unit() - 0.5f, SurfaceHeight(world, x, z) + 1.6f,
+                    z + rng.Unit() - 0.5f};
+    // Uniform direction on the sphere
+    float u = rng.Unit() * 2.0f - 1.0f;
+    float a = rng.Unit() * 6.2831853f;
+    float r = sqrtf(1.0f - u * u);
+    ray.direction = {r * cosf(a), u, r * sinf(a)};
+  }
+  return rays;
+}
+
+static BenchSeries BenchRaycast(World *world, const std::vector<Ray> &rays,
+                                int *hits) {
+  BenchSeries series = {"raycast", {}, false};
+  fprintf(stderr, "raycast x%zu\n", rays.size());
+  *hits = 0;
+  for (const Ray &ray : rays) {
+    Clock::time_point start = Clock::now();
+    World::WorldRayHit hit = world->GetRayCollision(ray);
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+    *hits += hit.hit;
+  }
+  return series;
+}
+
+// The original brute-force raycast, kept as the reference for the DDA: test
+// every solid block in a 17^3 cube around the origin, keep the nearest hit.
+static World::WorldRayHit ReferenceRayCollision(World *world, Ray ray) {
+  World::WorldRayHit closestHit = {false};
+  closestHit.distance = 999999.0f;
+  int cx = (int)ray.position.x;
+  int cy = (int)ray.position.y;
+  int cz = (int)ray.position.z;
+  int radius = 8;
+  for (int x = cx - radius; x <= cx + radius; x++) {
+    for (int y = std::max(cy - radius, 0);
+         y <= std::min(cy + radius, WORLD_HEIGHT - 1); y++) {
+      for (int z = cz - radius; z <= cz + radius; z++) {
+        if (!world->GetBlock(x, y, z).IsActive())
+          continue;
+        BoundingBox box = {
+            (Vector3){(float)x - 0.5f, (float)y - 0.5f, (float)z - 0.5f},
+            (Vector3){(float)x + 0.5f, (float)y + 0.5f, (float)z + 0.5f}};
+        RayCollision collision = GetRayCollisionBox(ray, box);
+        if (collision.hit && collision.distance < closestHit.distance) {
+          closestHit.hit = true;
+          closestHit.distance = collision.distance;
+          closestHit.x = x;
+          closestHit.y = y;
+          closestHit.z = z;
+          closestHit.normal = collision.normal;
+        }
+      }
+    }
+  }
+  return closestHit;
+}
+
+// Times the reference on the first `count` rays and checks the DDA agrees
+// with it. The cube reaches at least 7.5 blocks in every direction, so both
+// are compared with that reach, and a hit within it must come back the same
+// with unlimited reach too. Then rays that only meet air, level above and
+// below the world and out into unloaded land, must end with no hit when
+// given unlimited reach, as must any ray given none. Returns the number of
+// disagreements.
+static BenchSeries BenchRaycastReference(World *world,
+                                         const std::vector<Ray> &rays,
+                                         int count, int *mismatches) {
+  const float reach = 7.5f;
+  BenchSeries series = {"raycast_reference", {}, false};
+  fprintf(stderr, "raycast_reference x%d\n", count);
+  *mismatches = 0;
+  for (int i = 0; i < count && i < (int)rays.size(); i++) {
+    Clock::time_point start = Clock::now();
+    World::WorldRayHit expected = ReferenceRayCollision(world, rays[i]);
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+    expected.hit = expected.hit && expected.distance <= reach;
+
+    World::WorldRayHit hit = world->GetRayCollision(rays[i], reach);
+    bool same = hit.hit == expected.hit;
+    if (same && hit.hit) {
+      // GetRayCollisionBox gives a diagonal normal within ~0.005 of an edge,
+      // the DDA the face actually entered: it must be one of the diagonal's
+      // components (dot 0.707), otherwise equal (dot 1)
+      float dot = hit.normal.x * expected.normal.x +
+                  hit.normal.y * expected.normal.y +
+                  hit.normal.z * expected.normal.z;
+      same = hit.x == expected.x && hit.y == expected.y &&
+             hit.z == expected.z && dot > 0.5f &&
+             fabsf(hit.distance - expected.distance) < 1e-3f;
+    }
+    if (same && hit.hit) {
+      World::WorldRayHit unlimited = world->GetRayCollision(rays[i], INFINITY);
+      same = unlimited.hit && unlimited.x == hit.x && unlimited.y == hit.y &&
+             unlimited.z == hit.z;
+    }
+    if (!same) {
+      if (*mismatches < 10)
+        fprintf(stderr, "raycast mismatch on ray %d: dda %d (%d %d %d) "
+                        "reference %d (%d %d %d)\n",
+                i, hit.hit, hit.x, hit.y, hit.z, expected.hit, expected.x,
+                expected.y, expected.z);
+      (*mismatches)++;
+    }
+  }
+
+  const float heights[3] = {WORLD_HEIGHT + 2.0f, -3.0f, 40.0f};
+  const float starts[3] = {AREA_MIN, AREA_MIN, AREA_MAX + 100000.0f};
+  const float reaches[3] = {0.0f, -1.0f, NAN};
+  for (int i = 0; i < 3; i++) {
+    for (int k = 0; k < 8; k++) {
+      float a = k * 0.785398f; // Around the compass, axis-aligned included
+      Ray open = {{starts[i], heights[i], starts[i]}, {cosf(a), 0, sinf(a)}};
+      if (world->GetRayCollision(open, INFINITY).hit) {
+        fprintf(stderr, "raycast hit in open air at height %.0f\n",
+                heights[i]);
+        (*mismatches)++;
+      }
+    }
+    if (count > 0 && world->GetRayCollision(rays[0], reaches[i]).hit) {
+      fprintf(stderr, "raycast hit with reach %f\n", reaches[i]);
+      (*mismatches)++;
+    }
+  }
+  return series;
+}
+
+// Player-sized boxes standing on random surface points, moved by one frame
+// of walking, jumping or falling (up to a full-speed fall).
+static std::vector<BoundingBox> MakeMoves(World *world, int count,
+                                          BenchRng &rng,
+                                          std::vector<Vector3> *motions) {
+  std::vector<BoundingBox> boxes(count);
+  motions->resize(count);
+  for (int i = 0; i < count; i++) {
+    int x = rng.Range(AREA_MIN, AREA_MAX - 1);
+    int z = rng.Range(AREA_MIN, AREA_MAX - 1);
+    Vector3 feet = {x + rng.Unit() - 0.5f, SurfaceHeight(world, x, z) + 0.51f,
+                    z + rng.Unit() - 0.5f};
+    boxes[i] = {{feet.x - 0.3f, feet.y, feet.z - 0.3f},
+                {feet.x + 0.3f, feet.y + 1.8f, feet.z + 0.3f}};
+    (*motions)[i] = {(rng.Unit() * 2.0f - 1.0f) * 0.26f,
+                     rng.Unit() * 1.26f - 1.0f,
+                     (rng.Unit() * 2.0f - 1.0f) * 0.26f};
+  }
+  return boxes;
+}
+
+// True if a solid block overlaps the box, allowing `skin` of contact
+static bool BoxInSolid(World *world, BoundingBox box, float skin) {
+  for (int x = (int)floorf(box.min.x + 0.5f + skin);
+       x <= (int)floorf(box.max.x + 0.5f - skin); x++)
+    for (int y = (int)floorf(box.min.y + 0.5f + skin);
+         y <= (int)floorf(box.max.y + 0.5f - skin); y++)
+      for (int z = (int)floorf(box.min.z + 0.5f + skin);
+           z <= (int)floorf(box.max.z + 0.5f - skin); z++)
+        if (world->GetBlock(x, y, z).IsSolid())
+          return true;
+  return false;
+}
+
+// Also checks no move ends inside a block it didn't start in
+static BenchSeries BenchMoveBox(World *world,
+                                const std::vector<BoundingBox> &boxes,
+                                const std::vector<Vector3> &motions,
+                                double *lookups, int *overlaps) {
+  BenchSeries series = {"move_box", {}, false};
+  fprintf(stderr, "move_box x%zu\n", boxes.size());
+  *lookups = 0;
+  *overlaps = 0;
+  for (size_t i = 0; i < boxes.size(); i++) {
+    Clock::time_point start = Clock::now();
+    World::BoxMove move = world->MoveBox(boxes[i], motions[i]);
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+    *lookups += move.blocksTested;
+    BoundingBox moved = {Vector3Add(boxes[i].min, move.delta),
+                         Vector3Add(boxes[i].max, move.delta)};
+    if (BoxInSolid(world, moved, 1e-4f) &&
+        !BoxInSolid(world, boxes[i], 1e-4f))
+      (*overlaps)++;
+  }
+  *lookups /= std::max<size_t>(boxes.size(), 1);
+  return series;
+}
+
+// The player's original collision, kept as the reference: five substeps,
+// each moving X, Z, then Y and testing every cell the padded box covers
+static BenchSeries BenchMoveBoxReference(World *world,
+                                         const std::vector<BoundingBox> &boxes,
+                                         const std::vector<Vector3> &motions,
+                                         double *lookups) {
+  BenchSeries series = {"move_box_reference", {}, false};
+  fprintf(stderr, "move_box_reference x%zu\n", boxes.size());
+  *lookups = 0;
+  const float padding = 0.05f;
+  const int steps = 5;
+  for (size_t i = 0; i < boxes.size(); i++) {
+    Clock::time_point start = Clock::now();
+    float mn[3] = {boxes[i].min.x, boxes[i].min.y, boxes[i].min.z};
+    float mx[3] = {boxes[i].max.x, boxes[i].max.y, boxes[i].max.z};
+    float step[3] = {motions[i].x / steps, motions[i].y / steps,
+                     motions[i].z / steps};
+    const int order[3] = {0, 2, 1};
+    for (int s = 0; s < steps; s++) {
+      for (int a : order) {
+        mn[a] += step[a];
+        mx[a] += step[a];
+        bool blocked = false;
+        for (int x = (int)floorf(mn[0] + padding);
+             x <= (int)floorf(mx[0] - padding) && !blocked; x++)
+          for (int y = (int)floorf(mn[1] + padding);
+               y <= (int)floorf(mx[1] - padding) && !blocked; y++)
+            for (int z = (int)floorf(mn[2] + padding);
+                 z <= (int)floorf(mx[2] - padding) && !blocked; z++) {
+              (*lookups)++;
+              blocked = world->GetBlock(x, y, z).IsSolid();
+            }
+        if (blocked) {
+          mn[a] -= step[a];
+          mx[a] -= step[a];
+          step[a] = 0;
+        }
+      }
+    }
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+  }
+  *lookups /= std::max<size_t>(boxes.size(), 1);
+  return series;
+}
+
+// Chunk culling from player-like cameras: eye height above random surface
+// points, random yaw, pitch within +-30 degrees, at the default render
+// distance. The headless Update streams and meshes the columns around each
+// camera first (untimed), so the same chunks exist that Draw would see, and
+// evicts the rest of the area as cameras move. The timed pass includes
+// occlusion culling; an untimed frustum-only pass per camera shows how much
+// the visibility walk removes.
+static BenchSeries BenchCulling(World *world, const std::vector<Ray> &rays,
+                                int cameras, double *candidates,
+                                double *frustumOnly, double *visible) {
+  BenchSeries series = {"cull_chunks", {}, false};
+  fprintf(stderr, "cull_chunks x%d\n", cameras);
+  world->SetRenderDistance(DEFAULT_RENDER_DISTANCE);
+  std::vector<ChunkCoord> out;
+  *candidates = 0;
+  *frustumOnly = 0;
+  *visible = 0;
+  for (int i = 0; i < cameras && i < (int)rays.size(); i++) {
+    Camera3D camera = {0};
+    camera.position = rays[i].position;
+    // Yaw from the ray, pitch scaled down from its vertical component
+    Vector3 d = rays[i].direction;
+    float horizontal = sqrtf(d.x * d.x + d.z * d.z);
+    float pitch = d.y * 30.0f * (float)M_PI / 180.0f;
+    float h = horizontal > 0 ? cosf(pitch) / horizontal : 0.0f;
+    camera.target = {camera.position.x + d.x * h,
+                     camera.position.y + sinf(pitch),
+                     camera.position.z + d.z * h};
+    camera.up = {0, 1, 0};
+    camera.fovy = 70.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+    world->Update(camera.position);
+
+    Frustum frustum = FrustumFromCamera(camera, 800.0f / 450.0f);
+    world->SetOcclusionCulling(false);
+    world->CollectVisibleChunks(camera.position, frustum, out);
+    *frustumOnly += out.size();
+    world->SetOcclusionCulling(true);
+
+    Clock::time_point start = Clock::now();
+    world->CollectVisibleChunks(camera.position, frustum, out);
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+    *candidates += world->GetCandidateChunkCount();
+    *visible += out.size();
+  }
+  int n = (int)series.samples.size();
+  if (n > 0) {
+    *candidates /= n;
+    *frustumOnly /= n;
+    *visible /= n;
+  }
+  return series;
+}
+
+// Random place/remove edits around sea level, timed in batches
+static BenchSeries BenchSetBlock(World *world, int edits, BenchRng &rng) {
+  BenchSeries series = {"set_block", {}, false};
+  fprintf(stderr, "set_block x%d\n", edits);
+  struct Edit {
+    int x, y, z;
+    bool active;
+  };
+  std::vector<Edit> batch(edits);
+  for (Edit &e : batch)
+    e = {rng.Range(AREA_MIN, AREA_MAX - 1), rng.Range(48, 112),
+         rng.Range(AREA_MIN, AREA_MAX - 1), (rng.Next() & 1) != 0};
+
+  for (int i = 0; i < edits; i += EDIT_BATCH) {
+    int n = std::min(EDIT_BATCH, edits - i);
+    Clock::time_point start = Clock::now();
+    for (int k = 0; k < n; k++) {
+      const Edit &e = batch[i + k];
+      world->SetBlock(e.x, e.y, e.z, e.active, BLOCK_STONE);
+    }
+    series.samples.push_back({ElapsedNs(start), (double)n, 0});
+  }
+  return series;
+}
+
+// Edits that change the light, timed one by one: a block over the surface
+// (shades the ground below), a surface block dug out (lets the sky in), and
+// a lamp placed underground then taken out again. Each rep of four edits
+// leaves the surface as it found it, give or take the dug block.
+static BenchSeries BenchRelight(World *world, int edits, BenchRng &rng,
+                                double *meanCells, int *maxCells) {
+  BenchSeries series = {"relight", {}, false};
+  fprintf(stderr, "relight x%d\n", edits);
+  double totalCells = 0;
+  *maxCells = 0;
+  int x = 0, z = 0, surface = 0;
+  for (int i = 0; i < edits; i++) {
+    int kind = i % 4;
+    if (kind == 0) {
+      x = rng.Range(AREA_MIN, AREA_MAX - 1);
+      z = rng.Range(AREA_MIN, AREA_MAX - 1);
+      surface = WORLD_HEIGHT - 3;
+      while (surface > 8 && !world->GetBlock(x, surface, z).IsActive())
+        surface--;
+    }
+    Clock::time_point start = Clock::now();
+    switch (kind) {
+    case 0:
+      world->SetBlock(x, surface + 2, z, true, BLOCK_STONE);
+      break;
+    case 1:
+      world->SetBlock(x, surface, z, false, BLOCK_AIR);
+      break;
+    case 2:
+      world->SetBlock(x, surface - 4, z, true, BLOCK_LAMP);
+      break;
+    default:
+      world->SetBlock(x, surface - 4, z, false, BLOCK_AIR);
+      break;
+    }
+    series.samples.push_back({ElapsedNs(start), 1, 0});
+    int cells = world->GetRelightCellCount();
+    totalCells += cells;
+    *maxCells = std::max(*maxCells, cells);
+  }
+  *meanCells = edits > 0 ? totalCells / edits : 0;
+  return series;
+}
+
+// The same kind of random edits as set_block, applied as one ApplyEdits list
+// per batch
+static BenchSeries BenchApplyEdits(World *world, int edits, BenchRng &rng) {
+  BenchSeries series = {"apply_edits", {}, false};
+  fprintf(stderr, "apply_edits x%d\n", edits);
+  std::vector<BlockEdit> batch(edits);
+  for (BlockEdit &e : batch)
+    e = {rng.Range(AREA_MIN, AREA_MAX - 1), rng.Range(48, 112),
+         rng.Range(AREA_MIN, AREA_MAX - 1),
+         (rng.Next() & 1) ? BLOCK_STONE : BLOCK_AIR};
+
+  std::vector<BlockEdit> slice;
+  for (int i = 0; i < edits; i += EDIT_BATCH) {
+    int n = std::min(EDIT_BATCH, edits - i);
+    slice.assign(batch.begin() + i, batch.begin() + i + n);
+    Clock::time_point start = Clock::now();
+    world->ApplyEdits(slice);
+    series.samples.push_back({ElapsedNs(start), (double)n, 0});
+  }
+  return series;
+}
+
+// A FILL_BOX_SIZE cube of blocks per sample, alternating stone and air, either
+// with FillBox or with the equivalent SetBlock loop. Ops are blocks.
+static BenchSeries BenchFillBox(World *world, int reps, bool useSetBlock) {
+  BenchSeries series = {useSetBlock ? "fill_box_set_block" : "fill_box",
+                        {},
+                        false};
+  fprintf(stderr, "%s\n", series.name.c_str());
+  int x0 = ISLAND_SIZE / 2 - FILL_BOX_SIZE / 2, y0 = 40;
+  int z0 = ISLAND_SIZE / 2 - FILL_BOX_SIZE / 2;
+  int x1 = x0 + FILL_BOX_SIZE - 1, y1 = y0 + FILL_BOX_SIZE - 1;
+  int z1 = z0 + FILL_BOX_SIZE - 1;
+  double blocks = (double)FILL_BOX_SIZE * FILL_BOX_SIZE * FILL_BOX_SIZE;
+  for (int r = 0; r < reps * 2; r++) {
+    bool solid = r % 2 == 0;
+    Clock::time_point start = Clock::now();
+    if (useSetBlock) {
+      for (int y = y0; y <= y1; y++)
+        for (int z = z0; z <= z1; z++)
+          for (int x = x0; x <= x1; x++)
+            world->SetBlock(x, y, z, solid, BLOCK_STONE);
+    } else {
+      world->FillBox(x0, y0, z0, x1, y1, z1, solid ? BLOCK_STONE : BLOCK_AIR);
+    }
+    series.samples.push_back({ElapsedNs(start), blocks, 0});
+  }
+  return series;
+}
+
+// A stone tank underground: a pool of sources over a WATER_TANK_SIZE cavern,
+// with a slab between them that's dug out, so the pool floods the cavern.
+// Every tick until the water settles is a sample; ops are the cells looked
+// at.
+static BenchSeries BenchWater(World *world, int reps, int *ticks,
+                              int *maxPending) {
+  BenchSeries series = {"water_tick", {}, false};
+  int x0 = AREA_MIN + 16, z0 = AREA_MIN + 16, y0 = 10;
+  int x1 = x0 + WATER_TANK_SIZE - 1, z1 = z0 + WATER_TANK_SIZE - 1;
+  *ticks = 0;
+  *maxPending = 0;
+  for (int r = 0; r < reps; r++) {
+    fprintf(stderr, "water_tick %d/%d\n", r + 1, reps);
+    world->FillBox(x0 - 1, y0 - 1, z0 - 1, x1 + 1, y0 + 31, z1 + 1,
+                   BLOCK_STONE);
+    world->FillBox(x0, y0, z0, x1, y0 + 23, z1, BLOCK_AIR);
+    world->FillBox(x0, y0 + 26, z0, x1, y0 + 30, z1, BLOCK_WATER);
+    // Let the wakes from building it settle before timing
+    for (int i = 0; i < WATER_MAX_TICKS; i++) {
+      world->TickWater();
+      WaterStats s = world->GetLastWaterStats();
+      if (s.changed == 0 && s.pending == 0)
+        break;
+    }
+    world->FillBox(x0, y0 + 24, z0, x1, y0 + 25, z1, BLOCK_AIR);
+    for (int i = 0; i < WATER_MAX_TICKS; i++) {
+      Clock::time_point start = Clock::now();
+      world->TickWater();
+      double ns = ElapsedNs(start);
+      WaterStats s = world->GetLastWaterStats();
+      if (s.changed == 0 && s.pending == 0)
+        break;
+      series.samples.push_back({ns, (double)s.cells, 0});
+      *maxPending = std::max(*maxPending, s.pending);
+      (*ticks)++;
+    }
+  }
+  *ticks /= reps;
+  return series;
+}
+
+int main(int argc, char **argv) {
+  int reps = 3;
+  int rays = 20000;
+  int checkRays = 2000; // The reference is slow
+  int cameras = 200;
+  int edits = 200000;
+  unsigned seed = 1;
+  int threads = std::max(1, (int)std::thread::hardware_concurrency());
+  bool csv = false;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--reps") && hasValue)
+      reps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--rays") && hasValue)
+      rays = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--check-rays") && hasValue)
+      checkRays = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--cameras") && hasValue)
+      cameras = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--edits") && hasValue)
+      edits = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && hasValue)
+      seed = (unsigned)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--threads") && hasValue)
+      threads = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--csv"))
+      csv = true;
+    else {
+      fprintf(stderr,
+              "usage: %s [--reps N] [--rays N] [--check-rays N] "
+              "[--cameras N] [--edits N] [--seed N] [--threads N] "
+              "[--csv]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (reps < 1)
+    reps = 1;
+
+  SetTraceLogLevel(LOG_WARNING);
+
+  // Far too big for the stack
+  World *world = new World();
+  BenchRng rng = {0x9E3779B97F4A7C15ULL ^ seed};
+
+  std::vector<BenchSeries> results;
+  results.push_back(BenchGenerate(world, reps, seed, threads));
+  std::filesystem::path saveDir =
+      std::filesystem::temp_directory_path() / "mini_minecraft_bench_save";
+  std::filesystem::remove_all(saveDir);
+  size_t voxelBytes = world->GetVoxelMemoryUsage();
+  size_t lightBytes = world->GetLightMemoryUsage();
+  LoadMemory readMemory = {0}, mappedMemory = {0};
+  BenchSaveLoad(world, reps, seed, threads, saveDir.c_str(), results,
+                &readMemory, &mappedMemory);
+  int corruptAccepted = 0;
+  results.push_back(BenchDecodeSection(world, &corruptAccepted));
+  fprintf(stderr, "decode_section: %d corrupt sections accepted\n",
+          corruptAccepted);
+  MeshCounts greedyCounts = {0}, naiveCounts = {0};
+  results.push_back(BenchMeshing(world, MESHING_GREEDY, &greedyCounts));
+  results.push_back(BenchMeshing(world, MESHING_NAIVE, &naiveCounts));
+  fprintf(stderr, "mesh vertices: %zu greedy, %zu naive (%.2fx)\n",
+          greedyCounts.vertices, naiveCounts.vertices,
+          (double)naiveCounts.vertices /
+              std::max<size_t>(greedyCounts.vertices, 1));
+  int floodMismatches = 0;
+  results.push_back(BenchMeshFloodWorst(reps, &floodMismatches));
+  fprintf(stderr, "mesh_flood_worst: %d/%d visibility mismatches\n",
+          floodMismatches, reps);
+  std::vector<Ray> rayBatch = MakeRays(world, rays, rng);
+  int hits = 0;
+  results.push_back(BenchRaycast(world, rayBatch, &hits));
+  fprintf(stderr, "raycast hits %d/%d\n", hits, rays);
+  int mismatches = 0;
+  results.push_back(
+      BenchRaycastReference(world, rayBatch, checkRays, &mismatches));
+  fprintf(stderr, "raycast mismatches vs reference %d/%d\n", mismatches,
+          std::min(checkRays, rays));
+  std::vector<Vector3> motions;
+  std::vector<BoundingBox> boxes = MakeMoves(world, rays, rng, &motions);
+  double sweepLookups = 0, stepLookups = 0;
+  int overlaps = 0;
+  results.push_back(
+      BenchMoveBox(world, boxes, motions, &sweepLookups, &overlaps));
+  results.push_back(
+      BenchMoveBoxReference(world, boxes, motions, &stepLookups));
+  fprintf(stderr,
+          "move_box lookups per move: %.1f (reference %.1f), "
+          "%d ended inside a block\n",
+          sweepLookups, stepLookups, overlaps);
+  results.push_back(BenchSetBlock(world, edits, rng));
+  double relightMean = 0;
+  int relightMax = 0;
+  results.push_back(BenchRelight(world, std::min(edits, 20000), rng,
+                                 &relightMean, &relightMax));
+  fprintf(stderr, "relight cells per edit: %.0f mean, %d max\n", relightMean,
+          relightMax);
+  double candidates = 0, frustumOnly = 0, visible = 0;
+  results.push_back(BenchCulling(world, rayBatch, cameras, &candidates,
+                                 &frustumOnly, &visible));
+  fprintf(stderr,
+          "draw calls per camera: %.1f (%.1f in frustum, %.1f meshed)\n",
+          visible, frustumOnly, candidates);
+  fprintf(stderr, "columns: %d loaded, %d generated while culling\n",
+          world->GetLoadedColumnCount(), world->GetGeneratedColumnCount());
+
+  // After culling, so the fill box cave doesn't change what the cameras see.
+  // The cameras streamed columns out, so bring the whole area back first.
+  world->SetRenderDistance(MAX_RENDER_DISTANCE);
+  world->StreamColumns({ISLAND_SIZE / 2.0f, 80.0f, ISLAND_SIZE / 2.0f});
+  results.push_back(BenchApplyEdits(world, edits, rng));
+  results.push_back(BenchFillBox(world, reps, true));
+  results.push_back(BenchFillBox(world, reps, false));
+  int waterTicks = 0, waterPending = 0;
+  results.push_back(BenchWater(world, reps, &waterTicks, &waterPending));
+  fprintf(stderr, "water ticks to settle: %d, %d cells pending at most\n",
+          waterTicks, waterPending);
+  BenchAutosave(world, reps, results); // Last, it adds blocks at the top
+
+  if (csv)
+    PrintCsv(results);
+  else
+    PrintJson(results, reps, rays, edits, seed, threads, voxelBytes,
+              lightBytes, readMemory, mappedMemory, candidates, frustumOnly,
+              visible, greedyCounts, naiveCounts);
+
+  world->Unload();
+  delete world;
+  std::filesystem::remove_all(saveDir);
+  return mismatches == 0 && overlaps == 0 && corruptAccepted == 0 &&
+                 floodMismatches == 0
+             ? 0
+             : 2;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+// A byte wide, so the flowing water levels past the last enumerator are in
+// range
+enum BlockType : uint8_t {
+  BLOCK_AIR = 0,
+  BLOCK_DIRT,
+  BLOCK_GRASS,
+  BLOCK_STONE,
+  BLOCK_WOOD,
+  BLOCK_SAND,
+  BLOCK_LEAVES,
+  BLOCK_WATER, // A source: full, and stays put
+  BLOCK_LAMP,
+  // Flowing water, one type per level so the palette stores the level like
+  // any block: level n is BLOCK_WATER_FLOW + n - 1, up to WATER_FULL (water
+  // falling from above)
+  BLOCK_WATER_FLOW
+};
+
+#define WATER_FULL 8 // Sources and falling water; each step sideways loses 1
+#define BLOCK_TYPE_COUNT (BLOCK_WATER_FLOW + WATER_FULL) // Types are below
+
+inline bool IsWater(BlockType type) {
+  return type == BLOCK_WATER || (type >= BLOCK_WATER_FLOW &&
+                                 type < BLOCK_WATER_FLOW + WATER_FULL);
+}
+
+inline bool IsFlowingWater(BlockType type) {
+  return IsWater(type) && type != BLOCK_WATER;
+}
+
+// 0 for anything but water
+inline int WaterLevel(BlockType type) {
+  if (type == BLOCK_WATER)
+    return WATER_FULL;
+  return IsWater(type) ? type - BLOCK_WATER_FLOW + 1 : 0;
+}
+
+// Flowing water of a level from 1 to WATER_FULL, air for 0
+inline BlockType FlowingWater(int level) {
+  return level > 0 ? (BlockType)(BLOCK_WATER_FLOW + level - 1) : BLOCK_AIR;
+}
+
+// Light a block gives off, 0 to 15
+inline int BlockLightEmission(BlockType type) {
+  return type == BLOCK_LAMP ? 15 : 0;
+}
+
+// Levels light loses entering the block on top of the 1 per step; 15 stops
+// it. Sky light falls straight down through air without losing any.
+inline int BlockLightOpacity(BlockType type) {
+  if (IsWater(type))
+    return 2;
+  switch (type) {
+  case BLOCK_AIR:
+    return 0;
+  case BLOCK_LEAVES:
+    return 1;
+  default:
+    return 15;
+  }
+}
+
+struct Block {
+  BlockType type;
+
+  bool IsActive() const { return type != BLOCK_AIR; }
+  // Stops movement; water can be walked and fallen through
+  bool IsSolid() const { return IsActive() && !IsWater(type); }
+};
@@ -0,0 +1,307 @@
+#include "chunk_section.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes needed for a given index width: index words + counts + palette
+static size_t AllocSize(int bits) {
+  int capacity = 1 << bits;
+  return (size_t)CHUNK_VOLUME * bits / 8 + capacity * sizeof(uint16_t) +
+         capacity;
+}
+
+ChunkSection::ChunkSection()
+    : bits(0), uniformType(BLOCK_AIR), liveEntries(1), words(nullptr),
+      counts(nullptr), palette(nullptr) {}
+
+ChunkSection::~ChunkSection() { free(words); }
+
+void ChunkSection::WriteIndex(int i, int entry) {
+  int bitPos = i * bits;
+  uint64_t mask = (((uint64_t)1 << bits) - 1) << (bitPos & 63);
+  uint64_t &word = words[bitPos >> 6];
+  word = (word & ~mask) | ((uint64_t)entry << (bitPos & 63));
+}
+
+int ChunkSection::FindOrAddEntry(BlockType type) {
+  int capacity = 1 << bits;
+  int freeSlot = -1;
+  for (int i = 0; i < capacity; i++) {
+    if (counts[i] == 0) {
+      if (freeSlot < 0)
+        freeSlot = i;
+    } else if (palette[i] == type) {
+      return i;
+    }
+  }
+
+  if (freeSlot < 0) {
+    // Palette full: double the index width. Resize packs the live entries
+    // into the low slots, so the first free one is right after them.
+    Resize(bits * 2);
+    freeSlot = liveEntries;
+  }
+
+  palette[freeSlot] = (uint8_t)type;
+  liveEntries++;
+  return freeSlot;
+}
+
+void ChunkSection::Set(int lx, int ly, int lz, BlockType type) {
+  if (bits == 0) {
+    if (type == uniformType)
+      return; // Nothing changes, stay uniform
+    Resize(1);
+  }
+
+  int i = Index(lx, ly, lz);
+  int oldEntry = ReadIndex(i);
+  if (palette[oldEntry] == type)
+    return;
+
+  int newEntry = FindOrAddEntry(type);
+  oldEntry = ReadIndex(i); // Resize may have renumbered entries
+
+  WriteIndex(i, newEntry);
+  counts[newEntry]++;
+  if (--counts[oldEntry] == 0)
+    liveEntries--;
+
+  if (liveEntries == 1) {
+    Fill(type);
+  } else if (bits > 1 && liveEntries < (1 << (bits / 2))) {
+    // Shrink once the live types fit the narrower width with a slot to spare,
+    // so toggling one block back and forth doesn't repack every time.
+    Resize(bits / 2);
+  }
+}
+
+void ChunkSection::Fill(BlockType type) {
+  free(words);
+  words = nullptr;
+  counts = nullptr;
+  palette = nullptr;
+  bits = 0;
+  uniformType = (uint8_t)type;
+  liveEntries = 1;
+}
+
+void ChunkSection::CopyFrom(const ChunkSection &other) {
+  if (other.bits != bits) {
+    Fill(BLOCK_AIR);
+    if (other.bits > 0)
+      words = (uint64_t *)malloc(AllocSize(other.bits));
+  }
+  bits = other.bits;
+  uniformType = other.uniformType;
+  liveEntries = other.liveEntries;
+  if (bits == 0)
+    return;
+  memcpy(words, other.words, AllocSize(bits));
+  counts = (uint16_t *)((uint8_t *)words + (size_t)CHUNK_VOLUME * bits / 8);
+  palette = (uint8_t *)(counts + (1 << bits));
+}
+
+void ChunkSection::FillBox(int x0, int y0, int z0, int x1, int y1, int z1,
+                           BlockType type) {
+  if (x0 == 0 && y0 == 0 && z0 == 0 && x1 == CHUNK_SIZE - 1 &&
+      y1 == CHUNK_SIZE - 1 && z1 == CHUNK_SIZE - 1) {
+    Fill(type);
+    return;
+  }
+  if (bits == 0) {
+    if (type == uniformType)
+      return;
+    Resize(1);
+  }
+
+  int entry = FindOrAddEntry(type); // May widen, so before any index reads
+  for (int y = y0; y <= y1; y++) {
+    for (int z = z0; z <= z1; z++) {
+      for (int i = Index(x0, y, z), end = i + x1 - x0; i <= end; i++) {
+        int oldEntry = ReadIndex(i);
+        if (oldEntry == entry)
+          continue;
+        WriteIndex(i, entry);
+        counts[entry]++;
+        if (--counts[oldEntry] == 0)
+          liveEntries--;
+      }
+    }
+  }
+  Compact(); // The box may have replaced whole types
+}
+
+void PutSectionRun(std::vector<uint8_t> &out, int value, int length) {
+  out.push_back((uint8_t)value);
+  while (length >= 0x80) {
+    out.push_back((uint8_t)(length | 0x80));
+    length >>= 7;
+  }
+  out.push_back((uint8_t)length);
+}
+
+void ChunkSection::Encode(std::vector<uint8_t> &out) const {
+  if (bits == 0) {
+    PutSectionRun(out, uniformType, CHUNK_VOLUME);
+    return;
+  }
+  int runType = palette[ReadIndex(0)], runLength = 0;
+  for (int i = 0; i < CHUNK_VOLUME; i++) {
+    int type = palette[ReadIndex(i)];
+    if (type != runType) {
+      PutSectionRun(out, runType, runLength);
+      runType = type;
+      runLength = 0;
+    }
+    runLength++;
+  }
+  PutSectionRun(out, runType, runLength);
+}
+
+bool GetSectionRun(const uint8_t *data, size_t size, size_t &pos, int filled,
+                   int &value, int &length) {
+  if (pos >= size)
+    return false;
+  value = data[pos++];
+  length = 0;
+  for (int shift = 0;; shift += 7) {
+    if (pos >= size || shift > 14)
+      return false;
+    uint8_t byte = data[pos++];
+    length |= (byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  return length > 0 && length <= CHUNK_VOLUME - filled;
+}
+
+size_t ChunkSection::EncodedSize(const uint8_t *data, size_t size, int &runs) {
+  size_t pos = 0;
+  int filled = 0, type, length;
+  for (runs = 0; filled < CHUNK_VOLUME; runs++) {
+    if (!GetSectionRun(data, size, pos, filled, type, length) ||
+        type >= BLOCK_TYPE_COUNT)
+      return 0;
+    filled += length;
+  }
+  return pos;
+}
+
+size_t ChunkSection::Decode(const uint8_t *data, size_t size) {
+  uint8_t cells[CHUNK_VOLUME];
+  uint16_t typeCounts[256] = {0};
+  size_t pos = 0;
+  int filled = 0, type, length;
+  while (filled < CHUNK_VOLUME) {
+    if (!GetSectionRun(data, size, pos, filled, type, length) ||
+        type >= BLOCK_TYPE_COUNT)
+      return 0;
+    if (length == CHUNK_VOLUME) {
+      Fill((BlockType)type); // The usual case: all air, all stone, ...
+      return pos;
+    }
+    memset(cells + filled, type, length);
+    typeCounts[type] += length;
+    filled += length;
+  }
+
+  // Palette in order of first appearance, then one pass packing indices
+  int liveTypes = 0;
+  for (int t = 0; t < 256; t++)
+    liveTypes += typeCounts[t] > 0;
+  int newBits = 1;
+  while ((1 << newBits) < liveTypes)
+    newBits *= 2;
+  Fill(BLOCK_AIR); // Drops the old array
+  words = (uint64_t *)calloc(1, AllocSize(newBits));
+  counts = (uint16_t *)((uint8_t *)words + (size_t)CHUNK_VOLUME * newBits / 8);
+  palette = (uint8_t *)(counts + (1 << newBits));
+  bits = (uint8_t)newBits;
+  liveEntries = (uint16_t)liveTypes;
+
+  uint8_t entryOf[256];
+  int next = 0;
+  for (int i = 0; i < CHUNK_VOLUME; i++) {
+    int type = cells[i];
+    if (typeCounts[type] > 0) {
+      // First time this type shows up: give it the next palette slot
+      entryOf[type] = (uint8_t)next;
+      palette[next] = (uint8_t)type;
+      counts[next] = typeCounts[type];
+      typeCounts[type] = 0;
+      next++;
+    }
+    int bitPos = i * newBits;
+    words[bitPos >> 6] |= (uint64_t)entryOf[type] << (bitPos & 63);
+  }
+  return pos;
+}
+
+void ChunkSection::Compact() {
+  if (bits == 0)
+    return;
+  if (liveEntries == 1) {
+    for (int i = 0; i < (1 << bits); i++) {
+      if (counts[i] > 0) {
+        Fill((BlockType)palette[i]);
+        return;
+      }
+    }
+  }
+
+  int needed = 1;
+  while ((1 << needed) < liveEntries)
+    needed *= 2;
+  if (needed < bits)
+    Resize(needed);
+}
+
+void ChunkSection::Resize(int newBits) {
+  int newCapacity = 1 << newBits;
+  uint64_t *newWords = (uint64_t *)calloc(1, AllocSize(newBits));
+  uint16_t *newCounts =
+      (uint16_t *)((uint8_t *)newWords + (size_t)CHUNK_VOLUME * newBits / 8);
+  uint8_t *newPalette = (uint8_t *)(newCounts + newCapacity);
+
+  if (bits == 0) {
+    // Expanding a uniform section: every cell points at entry 0
+    newPalette[0] = uniformType;
+    newCounts[0] = CHUNK_VOLUME;
+    liveEntries = 1;
+  } else {
+    // Pack live entries into the low slots and remap every index
+    uint8_t remap[256];
+    int next = 0;
+    for (int e = 0; e < (1 << bits); e++) {
+      if (counts[e] == 0)
+        continue;
+      remap[e] = (uint8_t)next;
+      newPalette[next] = palette[e];
+      newCounts[next] = counts[e];
+      next++;
+    }
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+      int bitPos = i * newBits;
+      newWords[bitPos >> 6] |= (uint64_t)remap[ReadIndex(i)] << (bitPos & 63);
+    }
+    free(words);
+  }
+
+  words = newWords;
+  counts = newCounts;
+  palette = newPalette;
+  bits = (uint8_t)newBits;
+}
+
+bool ChunkSection::Contains(BlockType type) const {
+  if (bits == 0)
+    return uniformType == type;
+  for (int i = 0; i < (1 << bits); i++)
+    if (counts[i] > 0 && palette[i] == type)
+      return true;
+  return false;
+}
+
+size_t ChunkSection::MemoryUsage() const {
+  return sizeof(ChunkSection) + (bits ? AllocSize(bits) : 0);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "block.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define CHUNK_SIZE 16
+#define CHUNK_VOLUME (CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE)
+
+// Runs of a section's Encode stream: the value (a block type, or a light
+// level), then how many cells in a row have it as a LEB128 varint.
+// GetSectionRun reads the run at pos and moves past it; false if the stream
+// ends first, or the run is empty or overflows the section's `filled` cells.
+void PutSectionRun(std::vector<uint8_t> &out, int value, int length);
+bool GetSectionRun(const uint8_t *data, size_t size, size_t &pos, int filled,
+                   int &value, int &length);
+
+// Palette-compressed block storage for one 16x16x16 chunk.
+// Each section keeps a small palette of the block types it contains and a
+// bit-packed array of palette indices, 1, 2, 4 or 8 bits wide. A section with
+// only one type stores no array at all (0 bits). Palette entries are reference
+// counted so the index width grows and shrinks as Set() adds or removes types.
+class ChunkSection {
+public:
+  ChunkSection();
+  ~ChunkSection();
+
+  BlockType Get(int lx, int ly, int lz) const {
+    if (bits == 0)
+      return (BlockType)uniformType;
+    return (BlockType)palette[ReadIndex(Index(lx, ly, lz))];
+  }
+
+  void Set(int lx, int ly, int lz, BlockType type);
+  void Fill(BlockType type);
+  // Sets the cells from (x0, y0, z0) to (x1, y1, z1), inclusive, to one type.
+  // The palette is searched once and cells are written in storage order; a
+  // box covering the whole section just becomes uniform.
+  void FillBox(int x0, int y0, int z0, int x1, int y1, int z1, BlockType type);
+  void Compact(); // Repack to the narrowest width that fits the live palette
+  // Makes this an exact copy of another section: one memcpy, and no
+  // allocation if the widths already match
+  void CopyFrom(const ChunkSection &other);
+
+  // Run-length code of the cells in storage order, for saving: runs of
+  // (type byte, length as a LEB128 varint). A uniform section is 3 bytes.
+  void Encode(std::vector<uint8_t> &out) const;
+  // Replaces the contents from an Encode stream, packed at the narrowest
+  // width. Returns the bytes read, or 0 if the stream is short or malformed
+  // (or has a type that isn't a BlockType).
+  size_t Decode(const uint8_t *data, size_t size);
+  // Bytes in the Encode stream at data, checked like Decode would but
+  // without decoding, and how many runs it has (1 = uniform). 0 if malformed.
+  static size_t EncodedSize(const uint8_t *data, size_t size, int &runs);
+
+  bool Contains(BlockType type) const; // Any cell, from the palette
+  bool IsUniform() const { return bits == 0; }
+  BlockType GetUniformType() const { return (BlockType)uniformType; }
+  int GetBitsPerBlock() const { return bits; }
+  int GetPaletteSize() const { return bits == 0 ? 1 : liveEntries; }
+  size_t MemoryUsage() const;
+
+  // Cells are laid out x fastest, then z, then y.
+  static int Index(int lx, int ly, int lz) {
+    return (ly * CHUNK_SIZE + lz) * CHUNK_SIZE + lx;
+  }
+
+private:
+  ChunkSection(const ChunkSection &) = delete;
+  ChunkSection &operator=(const ChunkSection &) = delete;
+
+  // Widths are powers of two, so an index never straddles two words
+  int ReadIndex(int i) const {
+    int bitPos = i * bits;
+    return (int)(words[bitPos >> 6] >> (bitPos & 63)) & ((1 << bits) - 1);
+  }
+  void WriteIndex(int i, int entry);
+  int FindOrAddEntry(BlockType type);
+  void Resize(int newBits);
+
+  uint8_t bits;        // 0 (uniform), 1, 2, 4 or 8
+  uint8_t uniformType; // Only meaningful while bits == 0
+  uint16_t liveEntries;
+
+  // One allocation holding the index words, then counts, then palette
+  uint64_t *words;
+  uint16_t *counts; // Cells referencing each palette entry, 0 = free slot
+  uint8_t *palette;
+};
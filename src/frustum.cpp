@@ -0,0 +1,110 @@
+#include "frustum.hpp"
+#include <math.h>
+
+// Matrices here are float[row][col] in OpenGL convention (column vectors,
+// clip = projection * view * point). raylib's Matrix names its fields by
+// column-major index, so element (row, col) is field m[col * 4 + row].
+static void MatrixToRows(const Matrix &m, float out[4][4]) {
+  const float rows[4][4] = {{m.m0, m.m4, m.m8, m.m12},
+                            {m.m1, m.m5, m.m9, m.m13},
+                            {m.m2, m.m6, m.m10, m.m14},
+                            {m.m3, m.m7, m.m11, m.m15}};
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++)
+      out[r][c] = rows[r][c];
+}
+
+static void MultiplyRows(const float a[4][4], const float b[4][4],
+                         float out[4][4]) {
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 4; c++) {
+      out[r][c] = 0.0f;
+      for (int k = 0; k < 4; k++)
+        out[r][c] += a[r][k] * b[k][c];
+    }
+  }
+}
+
+// Gribb-Hartmann: each clip plane is the last row of the view-projection
+// plus or minus one of the others (OpenGL clip space, -w <= x, y, z <= w)
+static Frustum FrustumFromViewProjection(const float m[4][4]) {
+  Frustum f;
+  for (int i = 0; i < 6; i++) {
+    int row = i / 2;
+    float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+    FrustumPlane &p = f.planes[i];
+    p.a = m[3][0] + sign * m[row][0];
+    p.b = m[3][1] + sign * m[row][1];
+    p.c = m[3][2] + sign * m[row][2];
+    p.d = m[3][3] + sign * m[row][3];
+  }
+  return f;
+}
+
+Frustum FrustumFromMatrices(const Matrix &view, const Matrix &projection) {
+  float v[4][4], p[4][4], vp[4][4];
+  MatrixToRows(view, v);
+  MatrixToRows(projection, p);
+  MultiplyRows(p, v, vp);
+  Frustum f = FrustumFromViewProjection(vp);
+  // The view is a rotation R plus translation t, so the eye is -R^T * t
+  f.eye.x = -(v[0][0] * v[0][3] + v[1][0] * v[1][3] + v[2][0] * v[2][3]);
+  f.eye.y = -(v[0][1] * v[0][3] + v[1][1] * v[1][3] + v[2][1] * v[2][3]);
+  f.eye.z = -(v[0][2] * v[0][3] + v[1][2] * v[1][3] + v[2][2] * v[2][3]);
+  return f;
+}
+
+Frustum FrustumFromCamera(Camera3D camera, float aspect) {
+  // Look-at view matrix
+  float fx = camera.target.x - camera.position.x;
+  float fy = camera.target.y - camera.position.y;
+  float fz = camera.target.z - camera.position.z;
+  float fl = sqrtf(fx * fx + fy * fy + fz * fz);
+  fx /= fl;
+  fy /= fl;
+  fz /= fl;
+  // side = forward x up
+  float sx = fy * camera.up.z - fz * camera.up.y;
+  float sy = fz * camera.up.x - fx * camera.up.z;
+  float sz = fx * camera.up.y - fy * camera.up.x;
+  float sl = sqrtf(sx * sx + sy * sy + sz * sz);
+  sx /= sl;
+  sy /= sl;
+  sz /= sl;
+  // up = side x forward
+  float ux = sy * fz - sz * fy;
+  float uy = sz * fx - sx * fz;
+  float uz = sx * fy - sy * fx;
+  Vector3 e = camera.position;
+  float view[4][4] = {{sx, sy, sz, -(sx * e.x + sy * e.y + sz * e.z)},
+                      {ux, uy, uz, -(ux * e.x + uy * e.y + uz * e.z)},
+                      {-fx, -fy, -fz, fx * e.x + fy * e.y + fz * e.z},
+                      {0, 0, 0, 1}};
+
+  // Perspective projection, fovy in degrees like raylib
+  float t = 1.0f / tanf(camera.fovy * 0.5f * (float)M_PI / 180.0f);
+  float n = FRUSTUM_NEAR, fr = FRUSTUM_FAR;
+  float proj[4][4] = {{t / aspect, 0, 0, 0},
+                      {0, t, 0, 0},
+                      {0, 0, (fr + n) / (n - fr), 2 * fr * n / (n - fr)},
+                      {0, 0, -1, 0}};
+
+  float vp[4][4];
+  MultiplyRows(proj, view, vp);
+  Frustum f = FrustumFromViewProjection(vp);
+  f.eye = e;
+  return f;
+}
+
+bool Frustum::IntersectsBox(Vector3 min, Vector3 max) const {
+  for (int i = 0; i < 6; i++) {
+    const FrustumPlane &p = planes[i];
+    // The box corner furthest along the plane normal
+    float x = p.a >= 0 ? max.x : min.x;
+    float y = p.b >= 0 ? max.y : min.y;
+    float z = p.c >= 0 ? max.z : min.z;
+    if (p.a * x + p.b * y + p.c * z + p.d < 0)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "../vendor/raylib/src/raylib.h"
+
+// Clip planes used by raylib's BeginMode3D (rlgl's RL_CULL_DISTANCE_*)
+#define FRUSTUM_NEAR 0.01f
+#define FRUSTUM_FAR 1000.0f
+
+// Plane a*x + b*y + c*z + d = 0, positive on the inside
+struct FrustumPlane {
+  float a, b, c, d;
+};
+
+// Six clip planes (left, right, bottom, top, near, far) in world space
+struct Frustum {
+  FrustumPlane planes[6];
+  Vector3 eye; // Camera position the planes were built from
+
+  // Conservative: may keep a box that is just outside near a corner
+  bool IntersectsBox(Vector3 min, Vector3 max) const;
+};
+
+// From view and projection matrices as rlgl stores them
+// (rlGetMatrixModelview() / rlGetMatrixProjection())
+Frustum FrustumFromMatrices(const Matrix &view, const Matrix &projection);
+
+// Same as what BeginMode3D sets up for a perspective camera, without a window
+Frustum FrustumFromCamera(Camera3D camera, float aspect);
@@ -0,0 +1,94 @@
+#include "light_section.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+LightSection::~LightSection() { free(nibbles); }
+
+void LightSection::Set(int i, int level) {
+  if (!nibbles) {
+    if (level == uniform)
+      return;
+    nibbles = (uint8_t *)malloc(CHUNK_VOLUME / 2);
+    memset(nibbles, uniform * 0x11, CHUNK_VOLUME / 2);
+  }
+  int shift = (i & 1) * 4;
+  uint8_t &pair = nibbles[i >> 1];
+  pair = (uint8_t)((pair & ~(15 << shift)) | (level << shift));
+}
+
+void LightSection::Fill(int level) {
+  free(nibbles);
+  nibbles = nullptr;
+  uniform = (uint8_t)level;
+}
+
+void LightSection::Compact() {
+  if (!nibbles)
+    return;
+  uint8_t first = nibbles[0];
+  if ((first & 15) != (first >> 4))
+    return;
+  for (int i = 1; i < CHUNK_VOLUME / 2; i++)
+    if (nibbles[i] != first)
+      return;
+  Fill(first & 15);
+}
+
+void LightSection::CopyFrom(const LightSection &other) {
+  if (!other.nibbles) {
+    Fill(other.uniform);
+    return;
+  }
+  if (!nibbles)
+    nibbles = (uint8_t *)malloc(CHUNK_VOLUME / 2);
+  memcpy(nibbles, other.nibbles, CHUNK_VOLUME / 2);
+}
+
+void LightSection::Encode(std::vector<uint8_t> &out) const {
+  if (!nibbles) {
+    PutSectionRun(out, uniform, CHUNK_VOLUME);
+    return;
+  }
+  int runLevel = Get(0), runLength = 0;
+  for (int i = 0; i < CHUNK_VOLUME; i++) {
+    int level = Get(i);
+    if (level != runLevel) {
+      PutSectionRun(out, runLevel, runLength);
+      runLevel = level;
+      runLength = 0;
+    }
+    runLength++;
+  }
+  PutSectionRun(out, runLevel, runLength);
+}
+
+size_t LightSection::Decode(const uint8_t *data, size_t size) {
+  size_t pos = 0;
+  int filled = 0, level, length;
+  while (filled < CHUNK_VOLUME) {
+    if (!GetSectionRun(data, size, pos, filled, level, length) ||
+        level > LIGHT_MAX)
+      return 0;
+    if (length == CHUNK_VOLUME) {
+      Fill(level); // Open sky or solid rock
+      return pos;
+    }
+    if (!nibbles)
+      nibbles = (uint8_t *)malloc(CHUNK_VOLUME / 2);
+    // Whole bytes at once, a nibble on either end
+    int i = filled, end = filled + length;
+    if (i & 1) {
+      nibbles[i >> 1] = (uint8_t)((nibbles[i >> 1] & 15) | level << 4);
+      i++;
+    }
+    memset(nibbles + (i >> 1), level * 0x11, (end - i) >> 1);
+    if ((end - i) & 1)
+      nibbles[end >> 1] = (uint8_t)level;
+    filled = end;
+  }
+  return pos;
+}
+
+size_t LightSection::MemoryUsage() const {
+  return sizeof(LightSection) + (nibbles ? CHUNK_VOLUME / 2 : 0);
+}
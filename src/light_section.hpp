@@ -0,0 +1,52 @@
+#pragma once
+#include "chunk_section.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define LIGHT_MAX 15
+
+enum LightChannel {
+  LIGHT_SKY = 0, // Full under open sky, fading under cover
+  LIGHT_BLOCK    // From blocks that give off light (BlockLightEmission)
+};
+
+// One channel of light (sky or block) for a 16x16x16 chunk: a level from 0
+// to LIGHT_MAX per cell, packed two cells to a byte in ChunkSection::Index
+// order, low nibble first. A chunk lit the same everywhere (open sky, solid
+// rock) stores no array, like a uniform ChunkSection; the first Set that
+// differs allocates it.
+class LightSection {
+public:
+  LightSection() : uniform(0), nibbles(nullptr) {}
+  ~LightSection();
+
+  int Get(int i) const {
+    if (!nibbles)
+      return uniform;
+    return (nibbles[i >> 1] >> ((i & 1) * 4)) & 15;
+  }
+  void Set(int i, int level);
+  void Fill(int level); // Every cell, frees the array
+  void Compact();       // Drops the array if every cell has the same level
+  void CopyFrom(const LightSection &other);
+
+  // Run-length code of the levels in cell order, for saving: the same runs
+  // as ChunkSection::Encode, with a level for the type. A uniform section is
+  // 3 bytes.
+  void Encode(std::vector<uint8_t> &out) const;
+  // Replaces the levels from an Encode stream. Returns the bytes read, or 0
+  // if the stream is short or malformed (or a level is over LIGHT_MAX).
+  size_t Decode(const uint8_t *data, size_t size);
+
+  bool IsUniform() const { return nibbles == nullptr; }
+  int GetUniformLevel() const { return uniform; } // While uniform
+  size_t MemoryUsage() const;
+
+private:
+  LightSection(const LightSection &) = delete;
+  LightSection &operator=(const LightSection &) = delete;
+
+  uint8_t uniform;
+  uint8_t *nibbles; // CHUNK_VOLUME / 2 bytes, null while uniform
+};
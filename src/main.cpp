@@ -1,5 +1,6 @@
 #include "math_utils.hpp"
 #include "player.hpp"
+#include "profiler.hpp"
 #include "world.hpp"
 
 int main(void) {
@@ -15,10 +16,37 @@ int main(void) {
   // (256*256*256 * sizeof(Block) is large)
   World *world = new World();
   world->Init();
+  // Edits persist in ./world; Unload below writes whatever is still loaded
+  if (!world->OpenSave("world"))
+    TraceLog(LOG_WARNING, "WORLD: could not open save, edits won't be kept");
 
+  // Only caps rendering: the player ticks at TICK_RATE either way
+  bool frameCap = true;
   SetTargetFPS(60);
 
+  bool showProfiler = false;
+
+  const double tickTime = 1.0 / TICK_RATE;
+  double tickAccumulator = 0.0; // Time passed that no tick has covered yet
+  double lastTime = GetTime();
+
   while (!WindowShouldClose()) {
+    int64_t frameStart = Profiler::NowNs();
+    double now = GetTime();
+    double frameTime = now - lastTime;
+    lastTime = now;
+    float alpha = 0.0f; // How far rendering is past the last tick
+
+    // Profiler: F3 toggles the overlay, F4 dumps the recent trace
+    if (IsKeyPressed(KEY_F3))
+      showProfiler = !showProfiler;
+    if (IsKeyPressed(KEY_F4)) {
+      bool ok = Profiler::DumpCsv("profile_trace.csv") &&
+                Profiler::DumpChromeTrace("profile_trace.json");
+      TraceLog(ok ? LOG_INFO : LOG_WARNING, "PROFILER: trace dump %s",
+               ok ? "written to profile_trace.csv/.json" : "failed");
+    }
+
     // State Machine
     static enum { TITLE, GAMEPLAY } currentScreen = TITLE;
 
@@ -34,7 +62,23 @@ int main(void) {
     } else {
       // Gameplay Logic
       // Update
-      player.Update(world);
+      {
+        ProfileScope scope(PROFILE_PLAYER_UPDATE);
+        player.HandleInput();
+        // As many fixed ticks as fit in the time passed; the rest waits for
+        // the next frame. After a long stall the extra ticks are dropped
+        // rather than run in a burst.
+        tickAccumulator += frameTime;
+        int ticks = 0;
+        while (tickAccumulator >= tickTime && ticks < MAX_TICKS_PER_FRAME) {
+          player.Tick(world);
+          tickAccumulator -= tickTime;
+          ticks++;
+        }
+        if (tickAccumulator >= tickTime)
+          tickAccumulator = fmod(tickAccumulator, tickTime);
+        alpha = (float)(tickAccumulator / tickTime);
+      }
       world->Update(player.GetPosition());
 
       // Hotbar Selection
@@ -57,6 +101,28 @@ int main(void) {
       if (IsKeyPressed(KEY_NINE))
         player.selectedSlot = 8;
 
+      // Toggle greedy / naive chunk meshing
+      if (IsKeyPressed(KEY_G))
+        world->SetMeshingMode(world->GetMeshingMode() == MESHING_GREEDY
+                                  ? MESHING_NAIVE
+                                  : MESHING_GREEDY);
+
+      // Toggle occlusion culling (frustum culling stays on)
+      if (IsKeyPressed(KEY_O))
+        world->SetOcclusionCulling(!world->GetOcclusionCulling());
+
+      // Uncap the frame rate, e.g. to see the interpolation hold up
+      if (IsKeyPressed(KEY_V)) {
+        frameCap = !frameCap;
+        SetTargetFPS(frameCap ? 60 : 0);
+      }
+
+      // Render distance, in chunks
+      if (IsKeyPressed(KEY_EQUAL))
+        world->SetRenderDistance(world->GetRenderDistance() + 1);
+      if (IsKeyPressed(KEY_MINUS))
+        world->SetRenderDistance(world->GetRenderDistance() - 1);
+
       // Scroll Wheel
       float wheel = GetMouseWheelMove();
       if (wheel != 0) {
@@ -94,13 +160,12 @@ int main(void) {
     } else {
       // GAMEPLAY DRAWING
       // Use RenderCamera for View Bobbing
-      BeginMode3D(player.GetRenderCamera());
-      world->Draw(player.GetPosition());
+      Camera3D view = player.GetRenderCamera(alpha);
+      BeginMode3D(view);
+      world->Draw(view.position);
 
       // Selection outline
-      Ray ray = {player.GetRenderCamera().position,
-                 Vector3Subtract(player.GetRenderCamera().target,
-                                 player.GetRenderCamera().position)};
+      Ray ray = {view.position, Vector3Subtract(view.target, view.position)};
       World::WorldRayHit hit = world->GetRayCollision(ray);
       if (hit.hit) {
         DrawCubeWires(Vector3Add(hit.position, (Vector3){0, 0, 0}), 1.01f,
@@ -122,14 +187,14 @@ int main(void) {
       if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
         player.TriggerSwing(); // ANIMATION
         // recalculate ray for logic
-        Ray logicRay = {player.GetRenderCamera().position,
-                        Vector3Subtract(player.GetRenderCamera().target,
-                                        player.GetRenderCamera().position)};
+        Ray logicRay = {view.position,
+                        Vector3Subtract(view.target, view.position)};
         World::WorldRayHit hitData = world->GetRayCollision(logicRay);
         if (hitData.hit) {
           Block b = world->GetBlock(hitData.x, hitData.y, hitData.z);
-          if (b.active) {
-            player.AddItem(b.type, 1);
+          if (b.IsActive()) {
+            if (!IsFlowingWater(b.type)) // Only a source fills a bucket
+              player.AddItem(b.type, 1);
             world->SetBlock(hitData.x, hitData.y, hitData.z, false, BLOCK_AIR);
           }
         }
@@ -138,10 +203,8 @@ int main(void) {
       // Placing (Right Click)
       if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
         player.TriggerSwing(); // ANIMATION
-        Ray logicRay = {player.GetRenderCamera().position,
-                        Vector3Normalize(Vector3Subtract(
-                            player.GetRenderCamera().target,
-                            player.GetRenderCamera().position))};
+        Ray logicRay = {view.position, Vector3Normalize(Vector3Subtract(
+                                           view.target, view.position))};
         World::WorldRayHit hitData = world->GetRayCollision(logicRay);
         if (hitData.hit) {
           // Use grid coordinates directly for precision
@@ -180,6 +243,8 @@ int main(void) {
         }
       }
 
+      int64_t hudStart = Profiler::NowNs();
+
       // HAND ANIMATION
       if (player.GetSelectedBlockType() != BLOCK_AIR) {
         Texture2D tex = world->GetBlockTexture(player.GetSelectedBlockType());
@@ -237,6 +302,9 @@ int main(void) {
       case BLOCK_WATER:
         blockName = "Water bucket";
         break;
+      case BLOCK_LAMP:
+        blockName = "Lamp";
+        break;
       default:
         blockName = "";
         break;
@@ -279,11 +347,20 @@ int main(void) {
 
       // Crosshair
       DrawText("+", screenWidth / 2 - 5, screenHeight / 2 - 10, 20, WHITE);
+      Profiler::Record(PROFILE_HUD, hudStart, Profiler::NowNs());
     }
     // Shared FPS
     DrawFPS(10, 10);
+    if (showProfiler)
+      Profiler::DrawOverlay(10, 32);
+
+    {
+      ProfileScope scope(PROFILE_PRESENT); // Includes the frame limiter wait
+      EndDrawing();
+    }
 
-    EndDrawing();
+    Profiler::Record(PROFILE_FRAME, frameStart, Profiler::NowNs());
+    Profiler::EndFrame();
   }
 
   world->Unload();
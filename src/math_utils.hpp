@@ -25,6 +25,11 @@ inline Vector3 Vector3Normalize(Vector3 v) {
   return Vector3Scale(v, 1.0f / length);
 }
 
+inline Vector3 Vector3Lerp(Vector3 v1, Vector3 v2, float amount) {
+  return (Vector3){v1.x + amount * (v2.x - v1.x), v1.y + amount * (v2.y - v1.y),
+                   v1.z + amount * (v2.z - v1.z)};
+}
+
 inline Vector3 Vector3CrossProduct(Vector3 v1, Vector3 v2) {
   return (Vector3){v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z,
                    v1.x * v2.y - v1.y * v2.x};
@@ -0,0 +1,466 @@
+#include "mesher.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+ChunkMeshData::ChunkMeshData()
+    : cx(0), cy(0), cz(0), vertexCount(0), minY(0), maxY(0),
+      visibility(CHUNK_VISIBILITY_ALL) {
+  vertices = (uint32_t *)malloc(CHUNK_MAX_QUADS * 4 * sizeof(uint32_t));
+}
+
+ChunkMeshData::~ChunkMeshData() { free(vertices); }
+
+// Face order: TOP (Y+), BOTTOM (Y-), FRONT (Z+), BACK (Z-), LEFT (X-),
+// RIGHT (X+)
+enum {
+  FACE_TOP = 0,
+  FACE_BOTTOM,
+  FACE_FRONT,
+  FACE_BACK,
+  FACE_LEFT,
+  FACE_RIGHT,
+  FACE_COUNT
+};
+
+static const int FACE_AXIS[FACE_COUNT] = {1, 1, 2, 2, 0, 0}; // Normal axis
+static const int FACE_DIR[FACE_COUNT] = {1, -1, 1, -1, -1, 1};
+static const int FACE_U_AXIS[FACE_COUNT] = {0, 0, 0, 0, 2, 2};
+static const int FACE_V_AXIS[FACE_COUNT] = {2, 2, 1, 1, 1, 1};
+
+// Quad corners on the unit cube at the block, ordered so the triangles
+// (0, 1, 2) and (0, 2, 3) wind CCW seen from outside.
+// On merged quads a 1 along the face's U or V axis means the far edge.
+static const int FACE_CORNERS[FACE_COUNT][4][3] = {
+    // TOP: TL, BL, BR, TR
+    {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}},
+    // BOTTOM
+    {{0, 0, 1}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}},
+    // FRONT: BL, BR, TR, TL
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+    // BACK: viewed from Z-, x+ is left
+    {{1, 0, 0}, {0, 0, 0}, {0, 1, 0}, {1, 1, 0}},
+    // LEFT: viewed from X-, z+ is right
+    {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}},
+    // RIGHT
+    {{1, 0, 1}, {1, 0, 0}, {1, 1, 0}, {1, 1, 1}}};
+
+// Atlas tile index (row * 8 + col) for a block face
+static int GetFaceTile(BlockType type, int face) {
+  // Default tile (everything same on all sides)
+  int tile = (int)type;
+  if (IsWater(type))
+    tile = BLOCK_WATER; // Every level
+
+  // Custom Multi-Face Textures
+  if (type == BLOCK_GRASS) {
+    if (face == FACE_TOP)
+      tile = 2; // Grass Top
+    else if (face == FACE_BOTTOM)
+      tile = 1; // Dirt Bottom
+    else
+      tile = ATLAS_TILES_PER_ROW + 2; // Grass Side (Row 1)
+  } else if (type == BLOCK_WOOD) {
+    if (face == FACE_TOP || face == FACE_BOTTOM)
+      tile = ATLAS_TILES_PER_ROW + 4; // Wood Top (Row 1)
+    else
+      tile = 4; // Wood Side
+  }
+  return tile;
+}
+
+// Occupancy bitmasks for a snapshot. Each row runs along x for one (y, z) of
+// the padded 18^3 snapshot, bit lx + 1 for local x (bits 0 and 17 are the
+// border), so one AND/shift tests a whole row of 16 faces at once.
+struct ChunkFaceMasks {
+  uint32_t solid[SNAPSHOT_SIZE][SNAPSHOT_SIZE];  // [ly + 1][lz + 1], non-air
+  uint32_t opaque[SNAPSHOT_SIZE][SNAPSHOT_SIZE]; // Non-air and not leaves
+  uint16_t visible[FACE_COUNT][CHUNK_SIZE][CHUNK_SIZE]; // [ly][lz], bit lx
+};
+
+// A face shows if the neighbour is air, or leaves next to a non-leaf block.
+// Put the other way: leaves are hidden by any block, everything else only by
+// blocks that aren't leaves.
+static inline uint16_t VisibleBits(uint32_t solid, uint32_t opaque,
+                                   uint32_t nSolid, uint32_t nOpaque) {
+  uint32_t leaves = solid & ~opaque;
+  return (uint16_t)((((opaque & ~nOpaque) | (leaves & ~nSolid)) >> 1) &
+                    0xFFFF);
+}
+
+// SWAR ("SIMD within a register") helpers: eight cells per 64-bit word, so
+// the mask build stays portable (arm64 and x86) without intrinsics.
+#define BYTES_LOW7 0x7F7F7F7F7F7F7F7FULL
+#define BYTES_ONE 0x0101010101010101ULL
+
+// 0x80 in every byte of v that is non-zero
+static inline uint64_t NonZeroBytes(uint64_t v) {
+  return (v | ((v & BYTES_LOW7) + BYTES_LOW7)) & ~BYTES_LOW7;
+}
+
+// Gathers the top bit of each byte into an 8-bit mask, byte 0 in bit 0
+static inline uint32_t ByteMaskToBits(uint64_t highBits) {
+  return (uint32_t)(((highBits >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+static void BuildFaceMasks(const ChunkSnapshot &snapshot, ChunkFaceMasks &m) {
+  const uint64_t leaves = BYTES_ONE * BLOCK_LEAVES;
+  for (int y = 0; y < SNAPSHOT_SIZE; y++) {
+    for (int z = 0; z < SNAPSHOT_SIZE; z++) {
+      const uint8_t *row = &snapshot.cells[(y * SNAPSHOT_SIZE + z) *
+                                           SNAPSHOT_SIZE];
+      uint32_t solid = 0, opaque = 0;
+      for (int x = 0; x < 16; x += 8) {
+        uint64_t cells;
+        memcpy(&cells, row + x, sizeof(cells)); // Little endian: x in byte 0
+        uint64_t set = NonZeroBytes(cells);
+        solid |= ByteMaskToBits(set) << x;
+        opaque |= ByteMaskToBits(set & NonZeroBytes(cells ^ leaves)) << x;
+      }
+      for (int x = 16; x < SNAPSHOT_SIZE; x++) {
+        solid |= (uint32_t)(row[x] != BLOCK_AIR) << x;
+        opaque |= (uint32_t)(row[x] != BLOCK_AIR && row[x] != BLOCK_LEAVES)
+                  << x;
+      }
+      m.solid[y][z] = solid;
+      m.opaque[y][z] = opaque;
+    }
+  }
+
+  for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+      int y = ly + 1, z = lz + 1;
+      uint32_t s = m.solid[y][z], o = m.opaque[y][z];
+      m.visible[FACE_TOP][ly][lz] =
+          VisibleBits(s, o, m.solid[y + 1][z], m.opaque[y + 1][z]);
+      m.visible[FACE_BOTTOM][ly][lz] =
+          VisibleBits(s, o, m.solid[y - 1][z], m.opaque[y - 1][z]);
+      m.visible[FACE_FRONT][ly][lz] =
+          VisibleBits(s, o, m.solid[y][z + 1], m.opaque[y][z + 1]);
+      m.visible[FACE_BACK][ly][lz] =
+          VisibleBits(s, o, m.solid[y][z - 1], m.opaque[y][z - 1]);
+      // X neighbours are the same row shifted by one bit
+      m.visible[FACE_LEFT][ly][lz] = VisibleBits(s, o, s << 1, o << 1);
+      m.visible[FACE_RIGHT][ly][lz] = VisibleBits(s, o, s >> 1, o >> 1);
+    }
+  }
+}
+
+// Light a face of local block (x, y, z) is drawn with: the brighter channel
+// of the cell in front
+static inline int FaceLight(const ChunkSnapshot &snapshot, int face, int x,
+                            int y, int z) {
+  int p[3] = {x, y, z};
+  p[FACE_AXIS[face]] += FACE_DIR[face];
+  int light = snapshot.light[ChunkSnapshot::Index(p[0], p[1], p[2])];
+  return std::max(light & 15, light >> 4);
+}
+
+static inline int SolidAt(const ChunkFaceMasks &m, int x, int y, int z) {
+  return (m.solid[y + 1][z + 1] >> (x + 1)) & 1;
+}
+
+// Ambient occlusion at the corners of a face of local block (x, y, z), two
+// bits each in FACE_CORNERS order. A corner sees the two cells beside it and
+// the one diagonal to it in the layer in front of the face: 3 when all are
+// open, one less for each block, and 0 when both sides are blocks.
+static inline int FaceAO(const ChunkFaceMasks &m, int face, int x, int y,
+                         int z) {
+  int p[3] = {x, y, z};
+  p[FACE_AXIS[face]] += FACE_DIR[face];
+  int ua = FACE_U_AXIS[face], va = FACE_V_AXIS[face];
+
+  // The 3x3 cells around the one in front, [v + 1][u + 1]
+  int ring[3][3];
+  for (int dv = -1; dv <= 1; dv++) {
+    for (int du = -1; du <= 1; du++) {
+      int q[3] = {p[0], p[1], p[2]};
+      q[ua] += du;
+      q[va] += dv;
+      ring[dv + 1][du + 1] = SolidAt(m, q[0], q[1], q[2]);
+    }
+  }
+
+  int ao = 0;
+  for (int k = 0; k < 4; k++) {
+    const int *c = FACE_CORNERS[face][k];
+    int u = c[ua] * 2, v = c[va] * 2; // Ring index of the corner's side
+    int side1 = ring[1][u], side2 = ring[v][1], corner = ring[v][u];
+    int level = side1 && side2 ? 0 : 3 - side1 - side2 - corner;
+    ao |= level << (k * 2);
+  }
+  return ao;
+}
+
+// Axes along which a face's corner occlusion doesn't change: bit 0 for U,
+// bit 1 for V. Faces with the same occlusion merge along those without
+// shading any differently, as the blend only varies across the other axis
+// (both with all four corners the same).
+static int FlatAOAxes(int face, int ao) {
+  int level[2][2]; // [v][u]
+  for (int k = 0; k < 4; k++) {
+    const int *c = FACE_CORNERS[face][k];
+    level[c[FACE_V_AXIS[face]]][c[FACE_U_AXIS[face]]] = (ao >> (k * 2)) & 3;
+  }
+  int axes = 0;
+  if (level[0][0] == level[0][1] && level[1][0] == level[1][1])
+    axes |= 1;
+  if (level[0][0] == level[1][0] && level[0][1] == level[1][1])
+    axes |= 2;
+  return axes;
+}
+
+// Emits a quad covering w x h block faces, starting at local block
+// (x, y, z) and extending along the face's U and V axes.
+static void EmitFace(ChunkMeshData &out, int face, BlockType type, int light,
+                     int ao, int x, int y, int z, int w, int h) {
+  int ext[3];
+  ext[FACE_AXIS[face]] = 1;
+  ext[FACE_U_AXIS[face]] = w;
+  ext[FACE_V_AXIS[face]] = h;
+  int tile = GetFaceTile(type, face);
+
+  // Quads split along corners 0-2. If the 1-3 corners are brighter, start
+  // from corner 1 so the split joins those instead; otherwise occlusion
+  // bleeds across the whole quad and shades it differently by orientation.
+  int first = ((ao >> 2) & 3) + (ao >> 6) > (ao & 3) + ((ao >> 4) & 3);
+  for (int k = 0; k < 4; k++) {
+    int corner = (first + k) & 3;
+    const int *c = FACE_CORNERS[face][corner];
+    out.vertices[out.vertexCount++] = PackChunkVertex(
+        x + c[0] * ext[0], y + c[1] * ext[1], z + c[2] * ext[2], face, tile,
+        light, (ao >> (corner * 2)) & 3);
+  }
+}
+
+static void BuildNaive(const ChunkSnapshot &snapshot,
+                       const ChunkFaceMasks &masks, ChunkMeshData &out) {
+  for (int face = 0; face < FACE_COUNT; face++) {
+    for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+      for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+        // Walk only the set bits of the row
+        uint32_t bits = masks.visible[face][ly][lz];
+        while (bits) {
+          int lx = __builtin_ctz(bits);
+          bits &= bits - 1;
+          EmitFace(out, face, snapshot.Get(lx, ly, lz),
+                   FaceLight(snapshot, face, lx, ly, lz),
+                   FaceAO(masks, face, lx, ly, lz), lx, ly, lz, 1, 1);
+        }
+      }
+    }
+  }
+}
+
+// For each face direction, scatter the visible faces into one 16x16 mask per
+// slice keyed by block type (the type fixes the tile for a given direction),
+// light and ambient occlusion, then sweep each non-empty slice merging runs
+// into the widest, then tallest, rectangles. Faces shaded unevenly by
+// occlusion only merge along an axis their occlusion doesn't change on: a
+// quad merged across the change would blend its corners over all of them.
+static void BuildGreedy(const ChunkSnapshot &snapshot,
+                        const ChunkFaceMasks &masks, ChunkMeshData &out) {
+  // The sweep clears every cell it merges, so the masks are all zero again
+  // after each face and only need clearing once
+  // Type in bits 0-7, light in 8-11, occlusion in 12-19
+  uint32_t sliceMasks[CHUNK_SIZE][CHUNK_SIZE * CHUNK_SIZE];
+  memset(sliceMasks, 0, sizeof(sliceMasks));
+
+  for (int face = 0; face < FACE_COUNT; face++) {
+    int axis = FACE_AXIS[face];
+    int ua = FACE_U_AXIS[face];
+    int va = FACE_V_AXIS[face];
+
+    uint32_t usedSlices = 0;
+    for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+      for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+        uint32_t bits = masks.visible[face][ly][lz];
+        while (bits) {
+          int lx = __builtin_ctz(bits);
+          bits &= bits - 1;
+          int p[3] = {lx, ly, lz};
+          sliceMasks[p[axis]][p[va] * CHUNK_SIZE + p[ua]] =
+              (uint32_t)(snapshot.Get(lx, ly, lz) |
+                         FaceLight(snapshot, face, lx, ly, lz) << 8 |
+                         FaceAO(masks, face, lx, ly, lz) << 12);
+          usedSlices |= 1u << p[axis];
+        }
+      }
+    }
+
+    while (usedSlices) {
+      int slice = __builtin_ctz(usedSlices);
+      usedSlices &= usedSlices - 1;
+      uint32_t *mask = sliceMasks[slice];
+
+      for (int b = 0; b < CHUNK_SIZE; b++) {
+        for (int a = 0; a < CHUNK_SIZE;) {
+          uint32_t key = mask[b * CHUNK_SIZE + a];
+          if (key == 0) {
+            a++;
+            continue;
+          }
+          int ao = key >> 12;
+          int flat = FlatAOAxes(face, ao);
+          int extentU = flat & 1 ? CHUNK_SIZE : 1;
+          int extentV = flat & 2 ? CHUNK_SIZE : 1;
+
+          int w = 1;
+          while (a + w < CHUNK_SIZE && w < extentU &&
+                 mask[b * CHUNK_SIZE + a + w] == key)
+            w++;
+
+          int h = 1;
+          while (b + h < CHUNK_SIZE && h < extentV) {
+            bool rowMatches = true;
+            for (int k = 0; k < w; k++) {
+              if (mask[(b + h) * CHUNK_SIZE + a + k] != key) {
+                rowMatches = false;
+                break;
+              }
+            }
+            if (!rowMatches)
+              break;
+            h++;
+          }
+
+          for (int r = 0; r < h; r++)
+            memset(&mask[(b + r) * CHUNK_SIZE + a], 0, w * sizeof(*mask));
+
+          int p[3];
+          p[axis] = slice;
+          p[ua] = a;
+          p[va] = b;
+          EmitFace(out, face, (BlockType)(key & 0xFF), (key >> 8) & 15, ao,
+                   p[0], p[1], p[2], w, h);
+          a += w;
+        }
+      }
+    }
+  }
+}
+
+// Flood fills the see-through cells one connected region at a time and links
+// every pair of chunk faces a region touches. Works on whole x rows: a row's
+// reached cells spread along their open runs, then into the four neighbouring
+// rows, so a region costs a few operations per row instead of per cell.
+static uint16_t BuildVisibility(const ChunkFaceMasks &masks) {
+  uint16_t open[CHUNK_SIZE][CHUNK_SIZE]; // [ly][lz], bit lx
+  uint16_t anyOpen = 0, allOpen = 0xFFFF;
+  for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+      open[ly][lz] = (uint16_t)(~(masks.opaque[ly + 1][lz + 1] >> 1) & 0xFFFF);
+      anyOpen |= open[ly][lz];
+      allOpen &= open[ly][lz];
+    }
+  }
+  if (anyOpen == 0)
+    return CHUNK_VISIBILITY_NONE;
+  if (allOpen == 0xFFFF)
+    return CHUNK_VISIBILITY_ALL;
+
+  struct RowSeed {
+    uint8_t ly, lz;
+    uint16_t bits;
+  };
+  // Every push claims at least one unseen cell, so this can't overflow
+  RowSeed stack[CHUNK_VOLUME];
+  uint16_t seen[CHUNK_SIZE][CHUNK_SIZE] = {{0}};
+  uint16_t visibility = 0;
+
+  for (int sy = 0; sy < CHUNK_SIZE; sy++) {
+    for (int sz = 0; sz < CHUNK_SIZE; sz++) {
+      while (uint16_t unseen = open[sy][sz] & ~seen[sy][sz]) {
+        // New region from the lowest unvisited open cell of this row
+        uint16_t seed = unseen & (uint16_t)-unseen;
+        seen[sy][sz] |= seed;
+        int top = 0;
+        stack[top++] = {(uint8_t)sy, (uint8_t)sz, seed};
+        int faces = 0;
+
+        while (top > 0) {
+          RowSeed r = stack[--top];
+          uint16_t row = open[r.ly][r.lz];
+
+          // Spread along the open runs holding the seed bits
+          uint16_t fill = r.bits, prev;
+          do {
+            prev = fill;
+            fill = (uint16_t)((fill | (fill << 1) | (fill >> 1)) & row);
+          } while (fill != prev);
+          seen[r.ly][r.lz] |= fill;
+
+          if (fill & 1)
+            faces |= 1 << CHUNK_FACE_NEG_X;
+          if (fill & 0x8000)
+            faces |= 1 << CHUNK_FACE_POS_X;
+          if (r.ly == 0)
+            faces |= 1 << CHUNK_FACE_NEG_Y;
+          if (r.ly == CHUNK_SIZE - 1)
+            faces |= 1 << CHUNK_FACE_POS_Y;
+          if (r.lz == 0)
+            faces |= 1 << CHUNK_FACE_NEG_Z;
+          if (r.lz == CHUNK_SIZE - 1)
+            faces |= 1 << CHUNK_FACE_POS_Z;
+
+          const int next[4][2] = {{r.ly - 1, r.lz},
+                                  {r.ly + 1, r.lz},
+                                  {r.ly, r.lz - 1},
+                                  {r.ly, r.lz + 1}};
+          for (int n = 0; n < 4; n++) {
+            int ny = next[n][0], nz = next[n][1];
+            if (ny < 0 || ny >= CHUNK_SIZE || nz < 0 || nz >= CHUNK_SIZE)
+              continue;
+            uint16_t reach = fill & open[ny][nz] & ~seen[ny][nz];
+            if (reach) {
+              seen[ny][nz] |= reach;
+              stack[top++] = {(uint8_t)ny, (uint8_t)nz, reach};
+            }
+          }
+        }
+
+        for (int a = 0; a < CHUNK_FACE_COUNT; a++)
+          for (int b = a + 1; b < CHUNK_FACE_COUNT; b++)
+            if ((faces >> a & 1) && (faces >> b & 1))
+              visibility |= ChunkFacePairBit(a, b);
+      }
+    }
+  }
+  return visibility;
+}
+
+void BuildChunkMesh(const ChunkSnapshot &snapshot, MeshingMode mode,
+                    ChunkMeshData &out) {
+  out.cx = snapshot.cx;
+  out.cy = snapshot.cy;
+  out.cz = snapshot.cz;
+  out.vertexCount = 0;
+
+  ChunkFaceMasks masks;
+  {
+    ProfileScope scope(PROFILE_MESH_CULL);
+    BuildFaceMasks(snapshot, masks);
+    out.visibility = BuildVisibility(masks);
+  }
+
+  ProfileScope scope(PROFILE_MESH_BUILD);
+  if (mode == MESHING_GREEDY)
+    BuildGreedy(snapshot, masks, out);
+  else
+    BuildNaive(snapshot, masks, out);
+
+  // Vertical extent for culling, so the box skips empty space above the
+  // surface and below the world floor
+  out.minY = CHUNK_SIZE;
+  out.maxY = 0;
+  for (int i = 0; i < out.vertexCount; i++) {
+    int y = (int)((out.vertices[i] >> 5) & 31);
+    if (y < out.minY)
+      out.minY = y;
+    if (y > out.maxY)
+      out.maxY = y;
+  }
+  if (out.vertexCount == 0)
+    out.minY = 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "block.hpp"
+#include "chunk_section.hpp"
+#include <stdint.h>
+
+#define SNAPSHOT_SIZE (CHUNK_SIZE + 2)
+#define SNAPSHOT_VOLUME (SNAPSHOT_SIZE * SNAPSHOT_SIZE * SNAPSHOT_SIZE)
+
+// Atlas is 8x8 tiles of 16px (128x128)
+#define ATLAS_TILES_PER_ROW 8
+
+// Worst case face count. Two touching cells never both show the face between
+// them, so at most one quad per cell boundary plane: 3 axes x 17 planes x 256.
+// Keeps every vertex index below 65536 for 16-bit index buffers.
+#define CHUNK_MAX_QUADS (3 * (CHUNK_SIZE + 1) * CHUNK_SIZE * CHUNK_SIZE)
+
+// Packed chunk vertex, 4 bytes:
+//   bits  0-4   local x (0-16)      bits 15-17  face id (see mesher.cpp)
+//   bits  5-9   local y (0-16)      bits 18-23  atlas tile (row * 8 + col)
+//   bits 10-14  local z (0-16)      bits 24-27  light (0-15)
+//                                   bits 28-29  ambient occlusion (0-3)
+//                                   bits 30-31  unused
+// Positions are relative to the chunk origin. The chunk shader rebuilds the
+// world position, the tile-local UV (from position and face) and the atlas
+// offset. Quads are 4 vertices drawn with a shared index buffer.
+// Light is the brighter of the sky and block light in the cell the face looks
+// into; ambient occlusion is 3 for an open corner down to 0 for a shut one.
+inline uint32_t PackChunkVertex(int x, int y, int z, int face, int tile,
+                                int light, int ao) {
+  return (uint32_t)x | ((uint32_t)y << 5) | ((uint32_t)z << 10) |
+         ((uint32_t)face << 15) | ((uint32_t)tile << 18) |
+         ((uint32_t)light << 24) | ((uint32_t)ao << 28);
+}
+
+// Sky and block light of one cell in a byte, sky in the low nibble
+inline uint8_t PackLight(int sky, int block) {
+  return (uint8_t)(sky | (block << 4));
+}
+
+// Chunk boundary faces for the visibility graph
+enum ChunkFace {
+  CHUNK_FACE_NEG_X = 0,
+  CHUNK_FACE_POS_X,
+  CHUNK_FACE_NEG_Y,
+  CHUNK_FACE_POS_Y,
+  CHUNK_FACE_NEG_Z,
+  CHUNK_FACE_POS_Z,
+  CHUNK_FACE_COUNT
+};
+
+// Visibility graph: one bit per unordered pair of chunk faces (15 pairs), set
+// when see-through cells (air, leaves) connect the two faces inside the chunk
+#define CHUNK_VISIBILITY_ALL 0x7FFF
+#define CHUNK_VISIBILITY_NONE 0
+
+inline uint16_t ChunkFacePairBit(int a, int b) {
+  if (a > b) {
+    int t = a;
+    a = b;
+    b = t;
+  }
+  // Pairs (0,1)..(0,5) are bits 0-4, (1,2)..(1,5) bits 5-8, and so on
+  return (uint16_t)(1 << (a * 5 - a * (a - 1) / 2 + (b - a - 1)));
+}
+
+enum MeshingMode {
+  MESHING_NAIVE = 0, // One quad per visible block face
+  MESHING_GREEDY     // Coplanar same-texture faces merged into larger quads
+};
+
+// Copy of one chunk plus a one block border taken from its neighbours, with
+// its light. Built on the main thread and then only read by the mesher, so
+// worker threads never touch live world storage. Cells outside the world are
+// air, in full sky light above it and dark below.
+struct ChunkSnapshot {
+  int cx, cy, cz;
+  uint8_t cells[SNAPSHOT_VOLUME];
+  uint8_t light[SNAPSHOT_VOLUME]; // PackLight
+
+  // Local coordinates range from -1 to CHUNK_SIZE (border included)
+  static int Index(int lx, int ly, int lz) {
+    return ((ly + 1) * SNAPSHOT_SIZE + (lz + 1)) * SNAPSHOT_SIZE + (lx + 1);
+  }
+  BlockType Get(int lx, int ly, int lz) const {
+    return (BlockType)cells[Index(lx, ly, lz)];
+  }
+};
+
+// CPU side geometry for one chunk: 4 packed vertices per quad.
+// The vertex array is allocated once for the worst case and reused across
+// builds, and is handed to the GPU as is (it is already the final layout).
+// Pages past the largest mesh built so far are never touched.
+struct ChunkMeshData {
+  int cx, cy, cz;
+  uint32_t *vertices; // CHUNK_MAX_QUADS * 4 entries
+  int vertexCount;
+  int minY, maxY; // Local Y range covered by the vertices (0-16)
+  uint16_t visibility; // Face pairs connected through open cells
+
+  ChunkMeshData();
+  ~ChunkMeshData();
+
+  int GetQuadCount() const { return vertexCount / 4; }
+
+private:
+  ChunkMeshData(const ChunkMeshData &) = delete;
+  ChunkMeshData &operator=(const ChunkMeshData &) = delete;
+};
+
+// Pure CPU, safe to call from any thread. Fills in the visibility graph too.
+void BuildChunkMesh(const ChunkSnapshot &snapshot, MeshingMode mode,
+                    ChunkMeshData &out);
@@ -0,0 +1,79 @@
+#include "noise.hpp"
+#include <math.h>
+
+// Finaliser from MurmurHash3: every input bit affects every output bit
+static uint32_t Mix32(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+uint32_t HashCoords(uint32_t seed, int x, int z) {
+  uint32_t h = Mix32(seed ^ 0x9E3779B9u);
+  h = Mix32(h ^ (uint32_t)x * 0x27D4EB2Du);
+  return Mix32(h ^ (uint32_t)z * 0x165667B1u);
+}
+
+// Eight gradients around the circle; the diagonals are unit length too
+static const float GRADIENTS[8][2] = {
+    {1.0f, 0.0f},          {-1.0f, 0.0f},       {0.0f, 1.0f},
+    {0.0f, -1.0f},         {0.7071f, 0.7071f},  {-0.7071f, 0.7071f},
+    {0.7071f, -0.7071f},   {-0.7071f, -0.7071f}};
+
+static float Dot(uint32_t seed, int ix, int iz, float dx, float dz) {
+  const float *g = GRADIENTS[HashCoords(seed, ix, iz) & 7];
+  return g[0] * dx + g[1] * dz;
+}
+
+// 6t^5 - 15t^4 + 10t^3, so the noise is smooth across cell edges
+static float Fade(float t) {
+  return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static float Lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+float GradientNoise2D(uint32_t seed, float x, float z) {
+  float fx = floorf(x), fz = floorf(z);
+  int ix = (int)fx, iz = (int)fz;
+  float dx = x - fx, dz = z - fz;
+
+  float n00 = Dot(seed, ix, iz, dx, dz);
+  float n10 = Dot(seed, ix + 1, iz, dx - 1.0f, dz);
+  float n01 = Dot(seed, ix, iz + 1, dx, dz - 1.0f);
+  float n11 = Dot(seed, ix + 1, iz + 1, dx - 1.0f, dz - 1.0f);
+
+  float u = Fade(dx), v = Fade(dz);
+  // Unit gradients peak at sqrt(0.5) in the cell centre; scale that to 1
+  return Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v) * 1.4142f;
+}
+
+float FbmNoise2D(uint32_t seed, float x, float z, int octaves,
+                 float lacunarity, float gain) {
+  float sum = 0.0f;
+  float frequency = 1.0f, amplitude = 1.0f;
+  for (int i = 0; i < octaves; i++) {
+    // Separate seeds, so octaves don't share a lattice point at the origin
+    sum += GradientNoise2D(seed + i * 0x9E3779B9u, x * frequency,
+                           z * frequency) *
+           amplitude;
+    frequency *= lacunarity;
+    amplitude *= gain;
+  }
+  return sum;
+}
+
+HashRng::HashRng(uint32_t seed, int x, int z) {
+  state = ((uint64_t)HashCoords(seed, x, z) << 32) |
+          HashCoords(seed ^ 0x5BD1E995u, x, z);
+}
+
+// SplitMix64: one add and a mix per draw, no shared state
+uint32_t HashRng::Next() {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+// Seeded, table-free noise and hashing for terrain generation. Every function
+// is pure: the same seed and coordinates give the same result on any thread,
+// in any order, so a chunk column can be generated on its own.
+
+// 32-bit hash of a seed and an integer lattice point
+uint32_t HashCoords(uint32_t seed, int x, int z);
+
+// 2D gradient (Perlin) noise, roughly -1 to 1 and 0 on every integer point
+float GradientNoise2D(uint32_t seed, float x, float z);
+
+// Octaves of GradientNoise2D, each with `lacunarity` times the frequency and
+// `gain` times the amplitude of the one before, and its own seed. Not
+// normalised, like the stb_perlin fBm behind raylib's GenImagePerlinNoise,
+// so it stays mostly within -1 to 1.
+float FbmNoise2D(uint32_t seed, float x, float z, int octaves,
+                 float lacunarity, float gain);
+
+// Random stream keyed on a lattice point, e.g. one per chunk column: each
+// column draws the same numbers no matter when or where it is generated
+struct HashRng {
+  uint64_t state;
+
+  HashRng(uint32_t seed, int x, int z);
+  uint32_t Next();
+  int Below(int n) { return (int)(Next() % (uint32_t)n); } // 0 to n - 1
+};
@@ -3,38 +3,6 @@
 #include "world.hpp"
 #include <math.h>
 
-// Helper for AABB collision
-bool CheckCollision(Vector3 pos, float radius, float height, World *world) {
-  // Player AABB relative to camera position
-  // Feet at pos.y - 1.5
-  // Head at pos.y + 0.3 (Camera is 1.5 up, player height is 1.8)
-  float padding = 0.05f; // Slight padding to prevent floating point errors
-  float minX = pos.x - radius + padding;
-  float maxX = pos.x + radius - padding;
-  float minZ = pos.z - radius + padding;
-  float maxZ = pos.z + radius - padding;
-  float minY = pos.y - 1.5f + padding;
-  float maxY = pos.y + 0.3f - padding;
-
-  int startX = (int)floor(minX);
-  int endX = (int)floor(maxX);
-  int startY = (int)floor(minY);
-  int endY = (int)floor(maxY);
-  int startZ = (int)floor(minZ);
-  int endZ = (int)floor(maxZ);
-
-  for (int x = startX; x <= endX; x++) {
-    for (int y = startY; y <= endY; y++) {
-      for (int z = startZ; z <= endZ; z++) {
-        Block b = world->GetBlock(x, y, z);
-        if (b.active && b.type != BLOCK_WATER) // Water is passable
-          return true;
-      }
-    }
-  }
-  return false;
-}
-
 Player::Player() {}
 
 void Player::Init() {
@@ -46,7 +14,11 @@ void Player::Init() {
   camera.fovy = 70.0f;
   camera.projection = CAMERA_PERSPECTIVE;
 
+  previousPosition = camera.position;
   velocity = (Vector3){0.0f, 0.0f, 0.0f};
+  moveInput = (Vector3){0.0f, 0.0f, 0.0f};
+  sprinting = false;
+  jumpQueued = false;
   isGrounded = false;
   gravity = 0.025f;
   jumpForce = 0.26f; // Reduced for ~1.25 block jump height
@@ -65,6 +37,7 @@ void Player::Init() {
   hotbar[1] = InventorySlot{BLOCK_STONE, 64};
   hotbar[2] = InventorySlot{BLOCK_GRASS, 64};
   hotbar[3] = InventorySlot{BLOCK_DIRT, 64};
+  hotbar[4] = InventorySlot{BLOCK_LAMP, 64};
 
   DisableCursor();
   isFlying = false;
@@ -75,6 +48,7 @@ void Player::Init() {
 
 void Player::Respawn() {
   camera.position = (Vector3){32.5f, 150.0f, 32.5f};
+  previousPosition = camera.position; // Jump there, don't glide
   velocity = (Vector3){0, 0, 0};
   isFlying = false;
 }
@@ -85,10 +59,13 @@ float Player::GetWalkBobbing() {
   return sinf(walkTime * 10.0f) * 0.1f; // Adjust frequency/amplitude
 }
 
-Camera3D Player::GetRenderCamera() {
+Camera3D Player::GetRenderCamera(float alpha) {
   Camera3D rCam = camera;
+  // Between the last two ticks; the look direction is this frame's
+  Vector3 look = Vector3Subtract(camera.target, camera.position);
+  rCam.position = Vector3Lerp(previousPosition, camera.position, alpha);
   rCam.position.y += GetWalkBobbing();
-  rCam.target.y += GetWalkBobbing(); // Look target also bobs
+  rCam.target = Vector3Add(rCam.position, look); // Look target also bobs
   return rCam;
 }
 
@@ -132,17 +109,16 @@ BlockType Player::GetSelectedBlockType() {
   return BLOCK_AIR;
 }
 
-void Player::Update(World *world) {
+void Player::HandleInput() {
   // Toggle Flight
   if (IsKeyPressed(KEY_F))
     isFlying = !isFlying;
 
   // Respawn / Reset
-  if (IsKeyPressed(KEY_R) || camera.position.y < -50.0f) {
+  if (IsKeyPressed(KEY_R))
     Respawn();
-  }
 
-  // 1. Mouse Rotate
+  // 1. Mouse Rotate, every frame so looking around isn't tied to the tick
   Vector2 mouseDelta = GetMouseDelta();
   float sensitivity = 0.003f;
 
@@ -169,21 +145,63 @@ void Player::Update(World *world) {
 
   camera.target = Vector3Add(camera.position, forward);
 
-  // 2. Movement
+  // 2. Movement keys, held for the ticks until the next frame
+  moveInput = Vector3{0.0f, 0.0f, 0.0f};
+  if (IsKeyDown(KEY_W))
+    moveInput.z += 1.0f;
+  if (IsKeyDown(KEY_S))
+    moveInput.z -= 1.0f;
+  if (IsKeyDown(KEY_A))
+    moveInput.x += 1.0f; // Inverted: Was -, now +
+  if (IsKeyDown(KEY_D))
+    moveInput.x -= 1.0f; // Inverted: Was +, now -
+  if (IsKeyDown(KEY_SPACE))
+    moveInput.y += 1.0f; // Flying only
+  if (IsKeyDown(KEY_LEFT_CONTROL))
+    moveInput.y -= 1.0f;
+  sprinting = IsKeyDown(KEY_LEFT_SHIFT);
+  // A press lasts one frame, which may run no tick at all: keep it for the
+  // next one
+  if (IsKeyPressed(KEY_SPACE))
+    jumpQueued = true;
+
+  // Animation Update
+  if (Vector3Length(velocity) > 0.01f && isGrounded && !isFlying) {
+    walkTime += GetFrameTime() * (sprinting ? 1.5f : 1.0f);
+  } else {
+    // Dampen back to 0 or just stop incrementing?
+    // For simple bobbing, just stop incrementing is fine, maybe snap to 0
+    // slowly? taking simple approach:
+    if (walkTime > 0)
+      walkTime = 0; // Reset for now so we don't stop mid-bob ideally
+  }
+
+  if (swingTimer > 0)
+    swingTimer -= GetFrameTime() * 5.0f; // Swing speed
+}
+
+void Player::Tick(World *world) {
+  previousPosition = camera.position;
+  bool jump = jumpQueued;
+  jumpQueued = false;
+
+  if (camera.position.y < -50.0f) {
+    Respawn();
+    return;
+  }
+
+  Vector3 forward =
+      Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+  Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+
   if (isFlying) {
     float flySpeed = 0.5f;
-    if (IsKeyDown(KEY_LEFT_SHIFT))
+    if (sprinting)
       flySpeed *= 2.0f;
 
     Vector3 moveDir = {0};
-    if (IsKeyDown(KEY_W))
-      moveDir = Vector3Add(moveDir, forward);
-    if (IsKeyDown(KEY_S))
-      moveDir = Vector3Subtract(moveDir, forward);
-    if (IsKeyDown(KEY_A))
-      moveDir = Vector3Subtract(moveDir, right);
-    if (IsKeyDown(KEY_D))
-      moveDir = Vector3Add(moveDir, right);
+    moveDir = Vector3Add(moveDir, Vector3Scale(forward, moveInput.z));
+    moveDir = Vector3Subtract(moveDir, Vector3Scale(right, moveInput.x));
 
     // Normalize logic for flight
     if (Vector3Length(moveDir) > 0.01f)
@@ -191,11 +209,7 @@ void Player::Update(World *world) {
 
     camera.position =
         Vector3Add(camera.position, Vector3Scale(moveDir, flySpeed));
-
-    if (IsKeyDown(KEY_SPACE))
-      camera.position.y += flySpeed;
-    if (IsKeyDown(KEY_LEFT_CONTROL))
-      camera.position.y -= flySpeed;
+    camera.position.y += moveInput.y * flySpeed;
 
     velocity = Vector3{0, 0, 0};
     camera.target = Vector3Add(camera.position, forward);
@@ -203,99 +217,50 @@ void Player::Update(World *world) {
   }
 
   // WALKING PHYSICS
-  Vector3 direction = Vector3{0.0f, 0.0f, 0.0f};
-  if (IsKeyDown(KEY_W))
-    direction.z += 1.0f;
-  if (IsKeyDown(KEY_S))
-    direction.z -= 1.0f;
-  if (IsKeyDown(KEY_A))
-    direction.x += 1.0f; // Inverted: Was -, now +
-  if (IsKeyDown(KEY_D))
-    direction.x -= 1.0f; // Inverted: Was +, now -
-
   // Move relative to Yaw only
   Vector3 flatForward = forward;
   flatForward.y = 0;
   flatForward = Vector3Normalize(flatForward);
   Vector3 flatRight = Vector3CrossProduct(flatForward, Vector3{0, 1, 0});
 
-  Vector3 moveDir = Vector3Add(Vector3Scale(flatForward, direction.z),
-                               Vector3Scale(flatRight, direction.x));
+  Vector3 moveDir = Vector3Add(Vector3Scale(flatForward, moveInput.z),
+                               Vector3Scale(flatRight, moveInput.x));
   if (Vector3Length(moveDir) > 0)
     moveDir = Vector3Normalize(moveDir);
 
   // Sprint Logic
   float currentSpeed = moveSpeed;
-  if (IsKeyDown(KEY_LEFT_SHIFT)) {
+  if (sprinting) {
     currentSpeed *= 1.7f; // Sprint multiplier
   }
 
   velocity.x = moveDir.x * currentSpeed;
   velocity.z = moveDir.z * currentSpeed;
 
-  // Animation Update
-  if (Vector3Length(velocity) > 0.01f && isGrounded && !isFlying) {
-    walkTime += GetFrameTime() * (IsKeyDown(KEY_LEFT_SHIFT) ? 1.5f : 1.0f);
-  } else {
-    // Dampen back to 0 or just stop incrementing?
-    // For simple bobbing, just stop incrementing is fine, maybe snap to 0
-    // slowly? taking simple approach:
-    if (walkTime > 0)
-      walkTime = 0; // Reset for now so we don't stop mid-bob ideally
-  }
-
-  if (swingTimer > 0)
-    swingTimer -= GetFrameTime() * 5.0f; // Swing speed
-
   velocity.y -= gravity;
   if (velocity.y < -1.0f)
     velocity.y = -1.0f;
 
-  if (isGrounded && IsKeyPressed(KEY_SPACE)) {
+  if (isGrounded && jump) {
     velocity.y = jumpForce;
     isGrounded = false;
   }
 
-  // Collision & Integration
+  // Collision & Integration: one sweep of the player's box through the grid
+  // Feet at pos.y - 1.5, head at pos.y + 0.3 (camera 1.5 up, 1.8 tall)
   Vector3 pos = camera.position;
-
-  // Use sub-stepping to prevent tunneling
-  int steps = 5;
-  Vector3 stepVel = Vector3Scale(velocity, 1.0f / steps);
-
-  for (int i = 0; i < steps; i++) {
-    // X Axis
-    pos.x += stepVel.x;
-    if (CheckCollision(pos, radius, height, world)) {
-      pos.x -= stepVel.x;
-      stepVel.x = 0;
-      velocity.x = 0;
-    }
-
-    // Z Axis
-    pos.z += stepVel.z;
-    if (CheckCollision(pos, radius, height, world)) {
-      pos.z -= stepVel.z;
-      stepVel.z = 0;
-      velocity.z = 0;
-    }
-
-    // Y Axis
-    pos.y += stepVel.y;
-    if (CheckCollision(pos, radius, height, world)) {
-      // If moving down (falling)
-      if (stepVel.y < 0) {
-        isGrounded = true;
-      }
-      // If moving up (jumping)
-      if (stepVel.y > 0) {
-        velocity.y = 0; // Stop upward momentum
-      }
-      pos.y -= stepVel.y;
-      stepVel.y = 0;
-      velocity.y = 0;
-    }
-  }
+  BoundingBox box = {{pos.x - radius, pos.y - 1.5f, pos.z - radius},
+                     {pos.x + radius, pos.y - 1.5f + height, pos.z + radius}};
+  World::BoxMove move = world->MoveBox(box, velocity);
+  pos = Vector3Add(pos, move.delta);
+  if (move.hitX)
+    velocity.x = 0;
+  if (move.hitZ)
+    velocity.z = 0;
+  // Grounded only while standing on something, so walking off an edge falls
+  isGrounded = move.hitY && velocity.y < 0;
+  if (move.hitY)
+    velocity.y = 0;
 
   // Update camera
   camera.position = pos;
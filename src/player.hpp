@@ -4,16 +4,24 @@
 
 class World; // Forward declaration
 
+// Physics runs in fixed ticks, whatever the frame rate; speeds, gravity and
+// jump force are per tick
+#define TICK_RATE 60
+#define MAX_TICKS_PER_FRAME 5 // Beyond this a slow frame slows the game down
+
 class Player {
 public:
   Player();
   void Init();
-  void Update(World *world); // Handle input and movement with collision
+  void HandleInput();      // Every frame: looking around, toggles, keys held
+  void Tick(World *world); // One fixed step of movement with collision
 
   Camera3D GetCamera() { return camera; }
-  Vector3 GetPosition() { return camera.position; }
+  Vector3 GetPosition() { return camera.position; } // As of the last tick
 
-  Camera3D GetRenderCamera();
+  // `alpha` of the way from the tick before the last one to the last one
+  // (0 to 1), with view bobbing
+  Camera3D GetRenderCamera(float alpha);
 
   void Respawn(); // Resets player position
 
@@ -41,7 +49,11 @@ public:
 
 private:
   Camera3D camera;
+  Vector3 previousPosition; // Before the last tick, for GetRenderCamera
   Vector3 velocity;
+  Vector3 moveInput; // Keys held: x left/right, y up/down, z forward/back
+  bool sprinting;
+  bool jumpQueued; // Space pressed since the last tick
   bool isGrounded;
   float gravity;
   float jumpForce;
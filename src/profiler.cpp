@@ -0,0 +1,166 @@
+#include "profiler.hpp"
+#include "../vendor/raylib/src/raylib.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+
+static const char *PHASE_NAMES[PROFILE_PHASE_COUNT] = {
+    "frame",         "player update", "world update", "water tick",
+    "mesh snapshot", "mesh cull*",    "mesh build*",  "mesh upload",
+    "save snapshot", "save write*",   "raycast",      "world draw",
+    "hud",           "present"};
+
+struct TraceEvent {
+  int64_t startNs;
+  int64_t durationNs;
+  uint8_t phase;
+  uint8_t thread;
+};
+
+static std::mutex profilerMutex;
+static int64_t frameTotals[PROFILE_PHASE_COUNT];
+static int64_t history[PROFILE_PHASE_COUNT][PROFILER_WINDOW];
+static int historyHead = 0;  // Next slot to overwrite
+static int historyCount = 0; // Frames recorded, up to PROFILER_WINDOW
+static TraceEvent trace[PROFILER_TRACE_CAPACITY];
+static int traceHead = 0;
+static int traceCount = 0;
+
+// Small stable id per thread for the trace (first caller, the main thread,
+// gets 0)
+static int ThreadId() {
+  static std::atomic<int> nextId(0);
+  thread_local int id = nextId++;
+  return id;
+}
+
+int64_t Profiler::NowNs() {
+  static const std::chrono::steady_clock::time_point origin =
+      std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - origin)
+      .count();
+}
+
+void Profiler::Record(ProfilePhase phase, int64_t startNs, int64_t endNs) {
+  int thread = ThreadId();
+  std::lock_guard<std::mutex> lock(profilerMutex);
+  frameTotals[phase] += endNs - startNs;
+
+  TraceEvent &e = trace[(traceHead + traceCount) % PROFILER_TRACE_CAPACITY];
+  e.startNs = startNs;
+  e.durationNs = endNs - startNs;
+  e.phase = (uint8_t)phase;
+  e.thread = (uint8_t)thread;
+  if (traceCount < PROFILER_TRACE_CAPACITY)
+    traceCount++;
+  else
+    traceHead = (traceHead + 1) % PROFILER_TRACE_CAPACITY; // Drop oldest
+}
+
+void Profiler::EndFrame() {
+  std::lock_guard<std::mutex> lock(profilerMutex);
+  for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+    history[p][historyHead] = frameTotals[p];
+    frameTotals[p] = 0;
+  }
+  historyHead = (historyHead + 1) % PROFILER_WINDOW;
+  if (historyCount < PROFILER_WINDOW)
+    historyCount++;
+}
+
+ProfileStats Profiler::GetStats(ProfilePhase phase) {
+  ProfileStats stats = {0};
+  int64_t sorted[PROFILER_WINDOW];
+  int count;
+  {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    count = historyCount;
+    std::copy(history[phase], history[phase] + count, sorted);
+  }
+  if (count == 0)
+    return stats;
+
+  std::sort(sorted, sorted + count);
+  int64_t sum = 0;
+  for (int i = 0; i < count; i++)
+    sum += sorted[i];
+  int p99 = std::min(count - 1, count * 99 / 100);
+  stats.min = sorted[0] / 1e6f;
+  stats.avg = (float)(sum / count) / 1e6f;
+  stats.p99 = sorted[p99] / 1e6f;
+  return stats;
+}
+
+const char *Profiler::GetPhaseName(ProfilePhase phase) {
+  return PHASE_NAMES[phase];
+}
+
+// Copies the trace out so file writes don't hold the lock
+static int CopyTrace(TraceEvent *out) {
+  std::lock_guard<std::mutex> lock(profilerMutex);
+  for (int i = 0; i < traceCount; i++)
+    out[i] = trace[(traceHead + i) % PROFILER_TRACE_CAPACITY];
+  return traceCount;
+}
+
+bool Profiler::DumpCsv(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  TraceEvent *events = new TraceEvent[PROFILER_TRACE_CAPACITY];
+  int count = CopyTrace(events);
+  fprintf(f, "phase,thread,start_us,duration_us\n");
+  for (int i = 0; i < count; i++) {
+    const TraceEvent &e = events[i];
+    fprintf(f, "%s,%d,%.3f,%.3f\n", PHASE_NAMES[e.phase], e.thread,
+            e.startNs / 1000.0, e.durationNs / 1000.0);
+  }
+  delete[] events;
+  return fclose(f) == 0;
+}
+
+bool Profiler::DumpChromeTrace(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  TraceEvent *events = new TraceEvent[PROFILER_TRACE_CAPACITY];
+  int count = CopyTrace(events);
+  // Complete ("X") events, timestamps in microseconds
+  fprintf(f, "{\"traceEvents\": [\n");
+  for (int i = 0; i < count; i++) {
+    const TraceEvent &e = events[i];
+    fprintf(f,
+            "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+            "\"ts\": %.3f, \"dur\": %.3f}%s\n",
+            PHASE_NAMES[e.phase], e.thread, e.startNs / 1000.0,
+            e.durationNs / 1000.0, i + 1 < count ? "," : "");
+  }
+  fprintf(f, "]}\n");
+  delete[] events;
+  return fclose(f) == 0;
+}
+
+void Profiler::DrawOverlay(int x, int y) {
+  // The default font is proportional, so each column gets a fixed x
+  const int lineHeight = 14;
+  const int columns[3] = {x + 110, x + 160, x + 210};
+  DrawRectangle(x, y, 260, (PROFILE_PHASE_COUNT + 2) * lineHeight + 8,
+                (Color){0, 0, 0, 170});
+  DrawText("ms/frame", x + 6, y + 4, 10, YELLOW);
+  DrawText("min", columns[0], y + 4, 10, YELLOW);
+  DrawText("avg", columns[1], y + 4, 10, YELLOW);
+  DrawText("p99", columns[2], y + 4, 10, YELLOW);
+  for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+    ProfileStats s = GetStats((ProfilePhase)p);
+    int ly = y + 4 + (p + 1) * lineHeight;
+    DrawText(PHASE_NAMES[p], x + 6, ly, 10, WHITE);
+    DrawText(TextFormat("%.2f", s.min), columns[0], ly, 10, WHITE);
+    DrawText(TextFormat("%.2f", s.avg), columns[1], ly, 10, WHITE);
+    DrawText(TextFormat("%.2f", s.p99), columns[2], ly, 10, WHITE);
+  }
+  DrawText("* summed over background threads", x + 6,
+           y + 4 + (PROFILE_PHASE_COUNT + 1) * lineHeight, 10, LIGHTGRAY);
+}
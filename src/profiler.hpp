@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+#define PROFILER_WINDOW 300            // Frames kept for the rolling stats
+#define PROFILER_TRACE_CAPACITY 65536 // Most recent scopes kept for dumps
+
+// Timed phases. Mesh cull/build run on the mesh workers and save write on
+// the I/O thread, so their per-frame totals are CPU time summed over those
+// threads, not wall time.
+enum ProfilePhase {
+  PROFILE_FRAME = 0,
+  PROFILE_PLAYER_UPDATE,
+  PROFILE_WORLD_UPDATE,
+  PROFILE_WATER_TICK,
+  PROFILE_MESH_SNAPSHOT,
+  PROFILE_MESH_CULL,
+  PROFILE_MESH_BUILD,
+  PROFILE_MESH_UPLOAD,
+  PROFILE_SAVE_SNAPSHOT,
+  PROFILE_SAVE_WRITE,
+  PROFILE_RAYCAST,
+  PROFILE_WORLD_DRAW,
+  PROFILE_HUD,
+  PROFILE_PRESENT,
+  PROFILE_PHASE_COUNT
+};
+
+// Milliseconds per frame over the rolling window
+struct ProfileStats {
+  float min;
+  float avg;
+  float p99;
+};
+
+// Process-wide frame profiler. Record() is thread-safe; the rest is meant for
+// the main thread. Every scope adds to its phase's total for the current
+// frame and lands in a ring-buffered trace that can be dumped to disk.
+class Profiler {
+public:
+  static int64_t NowNs(); // Monotonic, relative to the first call
+  static void Record(ProfilePhase phase, int64_t startNs, int64_t endNs);
+
+  // Closes the current frame: per-phase totals go into the rolling window
+  static void EndFrame();
+
+  static ProfileStats GetStats(ProfilePhase phase);
+  static const char *GetPhaseName(ProfilePhase phase);
+
+  // Trace dumps, oldest event first. Return false if the file can't be written
+  static bool DumpCsv(const char *path);
+  static bool DumpChromeTrace(const char *path); // chrome://tracing, Perfetto
+
+  static void DrawOverlay(int x, int y);
+};
+
+// Times the enclosing block
+struct ProfileScope {
+  ProfilePhase phase;
+  int64_t startNs;
+
+  ProfileScope(ProfilePhase phase)
+      : phase(phase), startNs(Profiler::NowNs()) {}
+  ~ProfileScope() { Profiler::Record(phase, startNs, Profiler::NowNs()); }
+};
@@ -0,0 +1,411 @@
+#include "region.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Floor division, so negative columns land in negative regions
+static int ColumnToRegion(int c) {
+  return c >= 0 ? c / REGION_SIZE : (c + 1) / REGION_SIZE - 1;
+}
+
+static int EntryIndex(int cx, int cz) {
+  int lx = cx - ColumnToRegion(cx) * REGION_SIZE;
+  int lz = cz - ColumnToRegion(cz) * REGION_SIZE;
+  return lz * REGION_SIZE + lx;
+}
+
+// write() may stop short, e.g. on a signal
+static bool WriteAll(int fd, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+// pwrite() may stop short too
+static bool WriteAllAt(int fd, const void *data, size_t size, size_t offset) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (size > 0) {
+    ssize_t n = pwrite(fd, bytes, size, (off_t)offset);
+    if (n <= 0)
+      return false;
+    bytes += n;
+    offset += (size_t)n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+// FNV-1a over the generation and entries
+static uint32_t TableChecksum(const RegionTable &table) {
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+      hash = (hash ^ bytes[i]) * 16777619u;
+  };
+  mix(&table.generation, sizeof(table.generation));
+  mix(table.entries, sizeof(table.entries));
+  return hash;
+}
+
+// The newest table copy that isn't torn, -1 if neither is whole
+static int CurrentTable(const RegionHeader &header) {
+  int current = -1;
+  for (int slot = 0; slot < 2; slot++) {
+    const RegionTable &t = header.tables[slot];
+    if (t.checksum == TableChecksum(t) &&
+        (current < 0 || t.generation > header.tables[current].generation))
+      current = slot;
+  }
+  return current;
+}
+
+static uint32_t LiveBytes(const RegionTable &table) {
+  uint32_t bytes = 0;
+  for (const RegionEntry &e : table.entries)
+    if (e.offset != 0)
+      bytes += e.size;
+  return bytes;
+}
+
+RegionStore::RegionStore() : open(false), mapped(false), bytesWritten(0) {}
+
+RegionStore::~RegionStore() { Close(); }
+
+bool RegionStore::Open(const char *path, uint32_t &seed, bool mapped) {
+  Close();
+  if (!mapped) {
+    std::error_code error;
+    std::filesystem::create_directories(path, error);
+    if (error)
+      return false;
+  }
+  directory = path;
+
+  // level.dat holds the seed as text, written once when the save is created
+  std::string levelPath = directory + "/level.dat";
+  FILE *level = fopen(levelPath.c_str(), "r");
+  if (level) {
+    unsigned saved;
+    bool ok = fscanf(level, "seed %u", &saved) == 1;
+    fclose(level);
+    if (!ok)
+      return false;
+    seed = saved;
+  } else if (mapped) {
+    return false; // Nothing to map
+  } else {
+    level = fopen(levelPath.c_str(), "w");
+    if (!level)
+      return false;
+    fprintf(level, "seed %u\n", seed);
+    if (fclose(level) != 0)
+      return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  open = true;
+  this->mapped = mapped;
+  bytesWritten = 0;
+  return true;
+}
+
+void RegionStore::Close() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &entry : regions) {
+    if (entry.second->fd >= 0)
+      ::close(entry.second->fd);
+    if (entry.second->map)
+      munmap((void *)entry.second->map, entry.second->mapSize);
+    delete entry.second;
+  }
+  regions.clear();
+  open = false;
+}
+
+std::string RegionStore::RegionPath(int rx, int rz) const {
+  char name[48];
+  snprintf(name, sizeof(name), "/r.%d.%d.mmr", rx, rz);
+  return directory + name;
+}
+
+// Opens a region file on first use. Files that are missing are remembered
+// too, so generating new land doesn't retry open() for every column.
+RegionStore::Region *RegionStore::GetRegion(int rx, int rz) {
+  uint64_t key = ((uint64_t)(uint32_t)rx << 32) | (uint32_t)rz;
+  auto it = regions.find(key);
+  if (it != regions.end())
+    return it->second;
+
+  Region *region = new Region();
+  region->rx = rx;
+  region->rz = rz;
+  region->map = nullptr;
+  region->mapSize = 0;
+  region->bad = false;
+  memset(&region->table, 0, sizeof(region->table));
+  region->tableSlot = 0;
+  region->fileSize = 0;
+  region->liveBytes = 0;
+  region->fd =
+      ::open(RegionPath(rx, rz).c_str(), mapped ? O_RDONLY : O_RDWR);
+  regions[key] = region;
+  if (region->fd < 0)
+    return region;
+
+  RegionHeader h;
+  struct stat st;
+  bool read = fstat(region->fd, &st) == 0 && (size_t)st.st_size >= sizeof(h);
+  if (read && mapped) {
+    // The mapping keeps the file open
+    void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                     region->fd, 0);
+    if (map != MAP_FAILED) {
+      region->map = (const uint8_t *)map;
+      region->mapSize = (size_t)st.st_size;
+    }
+    ::close(region->fd);
+    region->fd = -1;
+    read = region->map != nullptr;
+    if (read)
+      memcpy(&h, region->map, sizeof(h));
+  } else if (read) {
+    read = pread(region->fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h);
+  }
+  int slot = read ? CurrentTable(h) : -1;
+  if (!read || h.magic != REGION_MAGIC || h.version != REGION_VERSION ||
+      slot < 0) {
+    if (region->fd >= 0)
+      ::close(region->fd);
+    if (region->map)
+      munmap((void *)region->map, region->mapSize);
+    region->fd = -1;
+    region->map = nullptr;
+    region->mapSize = 0;
+    region->bad = true;
+    return region;
+  }
+  region->table = h.tables[slot];
+  region->tableSlot = slot;
+  region->fileSize = (uint32_t)st.st_size;
+  region->liveBytes = LiveBytes(region->table);
+  return region;
+}
+
+bool RegionStore::Read(int cx, int cz, std::vector<uint8_t> &out) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!open)
+    return false;
+  Region *region = GetRegion(ColumnToRegion(cx), ColumnToRegion(cz));
+  int index = EntryIndex(cx, cz);
+  auto staged = region->staged.find(index);
+  if (staged != region->staged.end()) {
+    out = staged->second;
+    return true;
+  }
+  const RegionEntry &e = region->table.entries[index];
+  if (e.offset == 0)
+    return false;
+  if (region->map) {
+    if ((size_t)e.offset + e.size > region->mapSize)
+      return false;
+    out.assign(region->map + e.offset, region->map + e.offset + e.size);
+    return true;
+  }
+  if (region->fd < 0)
+    return false;
+  out.resize(e.size);
+  return pread(region->fd, out.data(), e.size, e.offset) == (ssize_t)e.size;
+}
+
+bool RegionStore::ReadMapped(int cx, int cz, const uint8_t *&data,
+                             size_t &size) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!open || !mapped)
+    return false;
+  Region *region = GetRegion(ColumnToRegion(cx), ColumnToRegion(cz));
+  const RegionEntry &e = region->table.entries[EntryIndex(cx, cz)];
+  if (!region->map || e.offset == 0 ||
+      (size_t)e.offset + e.size > region->mapSize)
+    return false;
+  data = region->map + e.offset;
+  size = e.size;
+  return true;
+}
+
+void RegionStore::Write(int cx, int cz, const uint8_t *data, size_t size) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!open || mapped)
+    return;
+  Region *region = GetRegion(ColumnToRegion(cx), ColumnToRegion(cz));
+  region->staged[EntryIndex(cx, cz)].assign(data, data + size);
+}
+
+bool RegionStore::Commit() {
+  std::vector<Region *> changed;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!open)
+      return false;
+    for (auto &entry : regions)
+      if (!entry.second->staged.empty())
+        changed.push_back(entry.second);
+  }
+  bool ok = true, renamed = false;
+  for (Region *region : changed)
+    ok = CommitRegion(region, renamed) && ok;
+
+  // A rename is only durable once the directory itself is synced
+  if (renamed) {
+    int dir = ::open(directory.c_str(), O_RDONLY);
+    ok = dir >= 0 && fsync(dir) == 0 && ok;
+    if (dir >= 0)
+      ::close(dir);
+  }
+  return ok;
+}
+
+// Appends the staged records and points the older table copy at them. Only
+// this thread changes the staged records, the table and the file past its
+// end, so reading them here needs no lock; readers keep using the current
+// table until the swap.
+bool RegionStore::CommitRegion(Region *region, bool &renamed) {
+  // A file we can't read is kept beside the save as .bad, and the region
+  // starts over from what is staged. Its other columns were unreadable
+  // anyway, so they are generated again.
+  if (region->bad) {
+    std::string path = RegionPath(region->rx, region->rz);
+    if (rename(path.c_str(), (path + ".bad").c_str()) != 0 && errno != ENOENT)
+      return false;
+    renamed = true;
+    std::lock_guard<std::mutex> lock(mutex);
+    region->bad = false;
+    memset(&region->table, 0, sizeof(region->table));
+    region->tableSlot = 0;
+    region->fileSize = 0;
+    region->liveBytes = 0;
+  }
+
+  RegionTable table = region->table;
+  table.generation++;
+  uint32_t live = region->liveBytes;
+  fileBuffer.clear();
+  for (auto &staged : region->staged) {
+    RegionEntry &e = table.entries[staged.first];
+    if (e.offset != 0)
+      live -= e.size;
+    e.offset = region->fileSize + (uint32_t)fileBuffer.size();
+    e.size = (uint32_t)staged.second.size();
+    live += e.size;
+    fileBuffer.insert(fileBuffer.end(), staged.second.begin(),
+                      staged.second.end());
+  }
+
+  // No file yet, or more dead records than live ones: write it afresh
+  size_t fileSize = region->fileSize + fileBuffer.size();
+  if (region->fd < 0 || fileSize - sizeof(RegionHeader) - live > live) {
+    if (!RewriteRegion(region))
+      return false;
+    renamed = true;
+    return true;
+  }
+
+  // Records before the table, so a table that made it to disk never points
+  // past them. After a failure the appended bytes are skipped all the same,
+  // as the table copy naming them may have reached the disk anyway.
+  int slot = region->tableSlot ^ 1;
+  table.checksum = TableChecksum(table);
+  size_t tableOffset =
+      offsetof(RegionHeader, tables) + slot * sizeof(RegionTable);
+  bool ok = WriteAllAt(region->fd, fileBuffer.data(), fileBuffer.size(),
+                       region->fileSize) &&
+            fsync(region->fd) == 0 &&
+            WriteAllAt(region->fd, &table, sizeof(table), tableOffset) &&
+            fsync(region->fd) == 0;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  region->fileSize = (uint32_t)fileSize;
+  if (!ok)
+    return false;
+  region->table = table;
+  region->tableSlot = slot;
+  region->liveBytes = live;
+  region->staged.clear();
+  bytesWritten += fileBuffer.size() + sizeof(table);
+  return true;
+}
+
+// Builds the whole file in memory, staged records over the saved ones, then
+// writes it beside the old file and renames it into place
+bool RegionStore::RewriteRegion(Region *region) {
+  RegionHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = REGION_MAGIC;
+  header.version = REGION_VERSION;
+  RegionTable &table = header.tables[0]; // The blank copy fails its checksum
+  table.generation = region->table.generation + 1;
+  fileBuffer.assign(sizeof(header), 0);
+  for (int i = 0; i < REGION_COLUMNS; i++) {
+    const RegionEntry &old = region->table.entries[i];
+    auto staged = region->staged.find(i);
+    RegionEntry &e = table.entries[i];
+    e.offset = (uint32_t)fileBuffer.size();
+    if (staged != region->staged.end()) {
+      e.size = (uint32_t)staged->second.size();
+      fileBuffer.insert(fileBuffer.end(), staged->second.begin(),
+                        staged->second.end());
+    } else if (old.offset != 0) {
+      e.size = old.size;
+      fileBuffer.resize(fileBuffer.size() + old.size);
+      if (pread(region->fd, fileBuffer.data() + e.offset, old.size,
+                old.offset) != (ssize_t)old.size)
+        return false;
+    } else {
+      e.offset = 0;
+    }
+  }
+  table.checksum = TableChecksum(table);
+  memcpy(fileBuffer.data(), &header, sizeof(header));
+
+  // The new file's descriptor follows it through the rename, so it becomes
+  // the one readers use
+  std::string path = RegionPath(region->rx, region->rz);
+  std::string temp = path + ".tmp";
+  int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  if (!WriteAll(fd, fileBuffer.data(), fileBuffer.size()) || fsync(fd) != 0 ||
+      rename(temp.c_str(), path.c_str()) != 0) {
+    ::close(fd);
+    unlink(temp.c_str());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (region->fd >= 0)
+    ::close(region->fd);
+  region->fd = fd;
+  region->table = table;
+  region->tableSlot = 0;
+  region->fileSize = (uint32_t)fileBuffer.size();
+  region->liveBytes = LiveBytes(table);
+  region->staged.clear();
+  bytesWritten += fileBuffer.size();
+  return true;
+}
+
+size_t RegionStore::GetBytesWritten() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return bytesWritten;
+}
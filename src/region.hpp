@@ -0,0 +1,111 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// On-disk world: one file per REGION_SIZE x REGION_SIZE chunk columns
+// (r.<rx>.<rz>.mmr in the save directory). A file starts with a fixed header
+// holding two copies of the offset table, one entry per column, then the
+// column records, so any column can be read with one table lookup and one
+// read. What a record holds is up to the caller (World encodes a column into
+// it).
+#define REGION_SIZE 32
+#define REGION_COLUMNS (REGION_SIZE * REGION_SIZE)
+#define REGION_MAGIC 0x47524D4Du // "MMRG"
+#define REGION_VERSION 3
+
+struct RegionEntry {
+  uint32_t offset; // Bytes from the file start, 0 if never written
+  uint32_t size;   // Bytes used by the record
+};
+
+// One copy of the offset table. Commits overwrite the older copy, so a crash
+// mid-write leaves the newer one whole; the checksum gives a torn copy away.
+struct RegionTable {
+  uint32_t generation; // The valid copy with the higher one is current
+  uint32_t checksum;   // Of the generation and entries
+  RegionEntry entries[REGION_COLUMNS]; // Column (lx, lz) at lz * SIZE + lx
+};
+
+struct RegionHeader {
+  uint32_t magic;
+  uint32_t version;
+  RegionTable tables[2];
+};
+
+// Writes are staged in memory and reach the disk in Commit. Only the staged
+// records are written: appended to the end of the region file and fsynced,
+// then the new table goes over the older table copy and is fsynced too.
+// Saved records are never overwritten, so a crash leaves the last complete
+// table and everything it points to. Once replaced records make up more of
+// the file than live ones, the region is compacted instead: rewritten whole
+// into a temp file, fsynced, then renamed over the old one. New regions are
+// written that way too, and so are regions whose file can't be read (another
+// version, or both tables torn), after moving it aside as r.<rx>.<rz>.mmr.bad.
+// Staged records are read back like saved ones.
+//
+// Opened mapped, region files are mmap'ed read only instead of read, for
+// big pre-built worlds: opening costs a table lookup per region, records are
+// used in place and the page cache decides what stays resident. Nothing is
+// written in that mode.
+//
+// Thread safe for reads from any thread while one thread at a time writes
+// and commits. The lock is only held for a table lookup and one read, or to
+// swap in a committed table, never across a write or fsync.
+class RegionStore {
+public:
+  RegionStore();
+  ~RegionStore();
+
+  // Creates the directory if needed. The world seed is kept beside the
+  // regions: a new save records `seed`, an existing one overwrites it.
+  // Mapped only opens an existing save.
+  bool Open(const char *directory, uint32_t &seed, bool mapped = false);
+  void Close(); // Drops anything staged since the last Commit, unmaps
+  bool IsOpen() const { return open; }
+  bool IsMapped() const { return mapped; }
+  bool IsWritable() const { return open && !mapped; }
+
+  // Record for column (cx, cz). False if it was never written or the file
+  // can't be read.
+  bool Read(int cx, int cz, std::vector<uint8_t> &out);
+  // Mapped only: the record in place, valid until Close
+  bool ReadMapped(int cx, int cz, const uint8_t *&data, size_t &size);
+  // Stages the column's record, replacing any earlier one. Ignored mapped.
+  void Write(int cx, int cz, const uint8_t *data, size_t size);
+  // Writes every region with staged records. False if any failed; those
+  // keep their records staged for the next try.
+  bool Commit();
+
+  size_t GetBytesWritten();
+
+private:
+  struct Region {
+    int rx, rz;
+    int fd;             // Read/write, -1 if the file doesn't exist yet
+    const uint8_t *map; // Mapped mode instead of fd, null if no file
+    size_t mapSize;
+    bool bad; // A file we can't parse: moved aside by the next commit
+    RegionTable table;  // The current copy
+    int tableSlot;      // Which of the header's copies it is
+    uint32_t fileSize;  // Where the next records are appended
+    uint32_t liveBytes; // Bytes of the records the table points to
+    std::map<int, std::vector<uint8_t>> staged; // By entry index
+  };
+
+  Region *GetRegion(int rx, int rz); // Lock held
+  bool CommitRegion(Region *region, bool &renamed);
+  bool RewriteRegion(Region *region);
+  std::string RegionPath(int rx, int rz) const;
+
+  std::mutex mutex;
+  bool open;
+  bool mapped;
+  std::string directory;
+  std::unordered_map<uint64_t, Region *> regions; // Opened so far
+  std::vector<uint8_t> fileBuffer;                 // Commit only
+  size_t bytesWritten;
+};
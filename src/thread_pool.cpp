@@ -0,0 +1,80 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool() : head(0), count(0), running(0), stopping(false) {
+  jobs.resize(64);
+}
+
+ThreadPool::~ThreadPool() { Stop(); }
+
+void ThreadPool::Start(int threadCount) {
+  stopping = false;
+  for (int i = 0; i < threadCount; i++)
+    workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+void ThreadPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    for (std::function<void()> &job : jobs)
+      job = nullptr;
+    head = 0;
+    count = 0;
+  }
+  wake.notify_all();
+  for (std::thread &worker : workers)
+    worker.join();
+  workers.clear();
+}
+
+void ThreadPool::Submit(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == jobs.size())
+      GrowQueue();
+    jobs[(head + count) % jobs.size()] = std::move(job);
+    count++;
+  }
+  wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this] { return count == 0 && running == 0; });
+}
+
+int ThreadPool::DefaultThreadCount() {
+  int cores = (int)std::thread::hardware_concurrency();
+  return cores > 2 ? cores - 1 : 1;
+}
+
+// Doubles the ring, unrolling queued jobs to the front (lock held)
+void ThreadPool::GrowQueue() {
+  std::vector<std::function<void()>> grown(jobs.size() * 2);
+  for (size_t i = 0; i < count; i++)
+    grown[i] = std::move(jobs[(head + i) % jobs.size()]);
+  jobs.swap(grown);
+  head = 0;
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return stopping || count > 0; });
+      if (stopping)
+        return;
+      job = std::move(jobs[head]);
+      jobs[head] = nullptr;
+      head = (head + 1) % jobs.size();
+      count--;
+      running++;
+    }
+    job();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--running == 0 && count == 0)
+      idle.notify_all();
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from a shared FIFO queue.
+// The queue is a ring buffer that only grows when full, so a steady stream of
+// small jobs (captures that fit std::function's inline storage) never
+// allocates.
+class ThreadPool {
+public:
+  ThreadPool();
+  ~ThreadPool();
+
+  void Start(int threadCount);
+  void Stop(); // Drops queued jobs and joins the workers
+  void Submit(std::function<void()> job);
+  void Wait(); // Blocks until every submitted job has finished
+
+  int GetThreadCount() const { return (int)workers.size(); }
+
+  // One worker per core, leaving one for the main thread
+  static int DefaultThreadCount();
+
+private:
+  void WorkerLoop();
+  void GrowQueue();
+
+  std::vector<std::thread> workers;
+  std::vector<std::function<void()>> jobs; // Ring buffer
+  size_t head;                             // Oldest queued job
+  size_t count;
+  int running; // Jobs taken off the queue and not finished yet
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  bool stopping;
+};
@@ -1,4 +1,9 @@
 #include "world.hpp"
+#include "../vendor/raylib/src/rlgl.h"
+#include "frustum.hpp"
+#include "noise.hpp"
+#include "profiler.hpp"
+#include <algorithm>
 #include <math.h>
 #include <stdlib.h>
 #include <vector>
@@ -15,11 +20,99 @@ static Color MakeColor(unsigned char r, unsigned char g, unsigned char b,
   return c;
 }
 
+// Chunk vertices are one packed uint32 (see PackChunkVertex), fed in as four
+// unsigned bytes and reassembled here. The tile-local UV comes from the
+// position along the face's axes, so merged quads repeat the tile via fract().
+// Faces are shaded by their light, each level 20% darker than the one above
+// it, and darkened towards corners closed in by blocks (ambient occlusion,
+// blended across the face).
+static const char *CHUNK_VS = R"(#version 330
+layout(location = 0) in vec4 packedVertex;
+uniform mat4 matView;
+uniform mat4 matProjection;
+uniform vec3 chunkOrigin;
+out vec2 tileUV;
+flat out vec2 tileOrigin;
+out float shade;
+void main() {
+  uint v = uint(packedVertex.x) | (uint(packedVertex.y) << 8) |
+           (uint(packedVertex.z) << 16) | (uint(packedVertex.w) << 24);
+  vec3 local = vec3(float(v & 31u), float((v >> 5) & 31u),
+                    float((v >> 10) & 31u));
+  uint face = (v >> 15) & 7u;
+  uint tile = (v >> 18) & 63u;
+
+  // Top/bottom map (x, z); sides run top-down from their top edge
+  if (face < 2u)
+    tileUV = local.xz;
+  else if (face < 4u)
+    tileUV = vec2(local.x, -local.y);
+  else
+    tileUV = vec2(local.z, -local.y);
+  tileOrigin = vec2(float(tile & 7u), float(tile >> 3)) / 8.0;
+  float light = float((v >> 24) & 15u);
+  float ao = float((v >> 28) & 3u);
+  shade = mix(0.05, 1.0, pow(0.8, 15.0 - light)) * mix(0.5, 1.0, ao / 3.0);
+
+  gl_Position = matProjection * matView * vec4(chunkOrigin + local, 1.0);
+}
+)";
+
+static const char *CHUNK_FS = R"(#version 330
+in vec2 tileUV;
+flat in vec2 tileOrigin;
+in float shade;
+uniform sampler2D texture0;
+out vec4 finalColor;
+void main() {
+  vec2 uv = tileOrigin + fract(tileUV) * (1.0 / 8.0);
+  vec4 texel = texture(texture0, uv);
+  finalColor = vec4(texel.rgb * shade, texel.a);
+}
+)";
+
 World::World() {
   // Constructor
 }
 
-void World::Init() {
+void World::Init(bool headless, uint32_t seed, int workerThreads) {
+  this->headless = headless;
+  this->seed = seed;
+
+  // 1-2. Textures, atlas, chunk shader, shared index buffer (needs a window)
+  if (!headless)
+    LoadRenderResources();
+
+  // 3. No terrain yet: Update generates columns around the player
+  lastColumn = nullptr;
+  columnsGenerated = 0;
+  columnsRead = 0;
+  autosaving = false;
+  lastAutosaveTime = 0.0;
+  lastSave = {0};
+  generateJobsInFlight = 0;
+  decorateJobsLeft = 0;
+  relightCellCount = 0;
+  lastWaterTime = 0.0;
+  lastWaterTick = {0};
+  waterActiveHead = 0;
+
+  meshingMode = MESHING_GREEDY;
+  renderDistance = DEFAULT_RENDER_DISTANCE;
+  candidateChunks = 0;
+  occlusionCulling = true;
+  hasLastFrustum = false;
+  meshJobsInFlight = 0;
+  meshAllocations = 0;
+  meshJobStorage.reserve(MAX_MESH_JOBS_IN_FLIGHT);
+  freeMeshJobs.reserve(MAX_MESH_JOBS_IN_FLIGHT);
+  meshResults.reserve(MAX_MESH_JOBS_IN_FLIGHT);
+  // Terrain uses the workers in both modes; headless meshing doesn't
+  workerPool.Start(workerThreads > 0 ? workerThreads
+                                     : ThreadPool::DefaultThreadCount());
+}
+
+void World::LoadRenderResources() {
   // 1. Generate Textures (Procedural Iconic Minecraft)
 
   // GRASS BLOCK (Top) - Vivid Green with noise
@@ -93,6 +186,13 @@ void World::Init() {
   Image imgWater = GenImageColor(16, 16, MakeColor(0, 50, 200, 200));
   blockTextures[BLOCK_WATER] = LoadTextureFromImage(imgWater);
 
+  // LAMP - Warm yellow with a bright centre
+  Image imgLamp = GenImageColor(16, 16, MakeColor(200, 150, 60, 255));
+  ImageDrawRectangle(&imgLamp, 3, 3, 10, 10, MakeColor(255, 230, 140, 255));
+  ImageDrawRectangleLines(&imgLamp, (Rectangle){0, 0, 16, 16}, 1,
+                          MakeColor(120, 80, 30, 255));
+  blockTextures[BLOCK_LAMP] = LoadTextureFromImage(imgLamp);
+
   blockTextures[BLOCK_AIR] = blockTextures[BLOCK_DIRT]; // Fallback
 
   // 2. Build Atlas
@@ -119,6 +219,9 @@ void World::Init() {
             (Rectangle){16 * 7, 0, 16, 16}, WHITE);
 
   // ROW 1
+  // Lamp at (0, 1): its block index runs past row 0
+  ImageDraw(&atlasImg, imgLamp, (Rectangle){0, 0, 16, 16},
+            (Rectangle){0, 16, 16, 16}, WHITE);
   // Grass Side at (2, 1) -> maps to same column as Grass but row 1
   ImageDraw(&atlasImg, imgGrassSide, (Rectangle){0, 0, 16, 16},
             (Rectangle){16 * 2, 16, 16, 16}, WHITE);
@@ -128,6 +231,24 @@ void World::Init() {
 
   atlasTexture = LoadTextureFromImage(atlasImg);
   UnloadImage(atlasImg);
+  chunkShader = LoadShaderFromMemory(CHUNK_VS, CHUNK_FS);
+  chunkOriginLoc = GetShaderLocation(chunkShader, "chunkOrigin");
+
+  // Every chunk draws quads as (0, 1, 2) (0, 2, 3), so one index buffer
+  // sized for the worst case chunk serves them all
+  std::vector<unsigned short> quadIndices(CHUNK_MAX_QUADS * 6);
+  for (int q = 0; q < CHUNK_MAX_QUADS; q++) {
+    unsigned short base = (unsigned short)(q * 4);
+    quadIndices[q * 6 + 0] = base;
+    quadIndices[q * 6 + 1] = base + 1;
+    quadIndices[q * 6 + 2] = base + 2;
+    quadIndices[q * 6 + 3] = base;
+    quadIndices[q * 6 + 4] = base + 2;
+    quadIndices[q * 6 + 5] = base + 3;
+  }
+  quadIndexBuffer = rlLoadVertexBufferElement(
+      quadIndices.data(), (int)(quadIndices.size() * sizeof(unsigned short)),
+      false);
 
   // Unload source images
   UnloadImage(imgGrass);
@@ -139,78 +260,102 @@ void World::Init() {
   UnloadImage(imgSand);
   UnloadImage(imgLeaves);
   UnloadImage(imgWater);
+  UnloadImage(imgLamp);
+}
 
-  // 3. Clear World
-  for (int x = 0; x < WORLD_WIDTH; x++) {
-    for (int y = 0; y < WORLD_HEIGHT; y++) {
-      for (int z = 0; z < WORLD_DEPTH; z++) {
-        grid[x][y][z].active = false;
-        grid[x][y][z].type = BLOCK_AIR;
-      }
+void World::Unload() {
+  // Stop the workers before tearing down anything a job might reference.
+  // Queued terrain jobs are dropped; their columns are deleted below.
+  workerPool.Stop();
+  generateResults.clear();
+  joinQueue.clear();
+  waterWake.clear();
+  waterActive.clear();
+  waterActiveHead = 0;
+  waterQueued.clear();
+
+  // Let evictions and any autosave finish, then save what is still loaded
+  if (regionStore.IsWritable()) {
+    ioPool.Wait();
+    ioPool.Stop();
+    CollectSavedColumns();
+    for (auto &entry : columns) {
+      ChunkColumn *column = entry.second;
+      if (column->state == COLUMN_GENERATING || !column->unsaved)
+        continue;
+      column->joinedSides = ReadySides(*column);
+      EncodeColumn(*column, saveRecord);
+      regionStore.Write(column->cx, column->cz, saveRecord.data(),
+                        saveRecord.size());
     }
+    if (!regionStore.Commit())
+      TraceLog(LOG_WARNING, "WORLD: failed to save some regions");
   }
-
-  // 4. Init Chunks
-  for (int cx = 0; cx < WORLD_WIDTH / CHUNK_SIZE; cx++) {
-    for (int cy = 0; cy < WORLD_HEIGHT / CHUNK_SIZE; cy++) {
-      for (int cz = 0; cz < WORLD_DEPTH / CHUNK_SIZE; cz++) {
-        chunks[cx][cy][cz].active = false;
-        chunks[cx][cy][cz].dirty = false;
-        chunks[cx][cy][cz].model = {0};
-      }
-    }
+  regionStore.Close(); // Unmaps a read-only save
+  for (ChunkColumn *snapshot : snapshots)
+    delete snapshot;
+  snapshots.clear();
+  for (MeshJob *job : meshJobStorage)
+    delete job;
+  meshJobStorage.clear();
+  freeMeshJobs.clear();
+  meshResults.clear();
+
+  // Mesh buffers go through UnloadChunkMesh, which skips GL when headless
+  for (auto &entry : columns) {
+    for (Chunk &chunk : entry.second->chunks)
+      UnloadChunkMesh(chunk);
+    delete entry.second;
   }
+  columns.clear();
+  for (ChunkColumn *column : freeColumns)
+    delete column;
+  freeColumns.clear();
+  lastColumn = nullptr;
 
-  // 5. Generate Terrain
-  GenerateTerrain();
-
-  // 6. Mark dirty
-  for (int cx = 0; cx < WORLD_WIDTH / CHUNK_SIZE; cx++) {
-    for (int cy = 0; cy < WORLD_HEIGHT / CHUNK_SIZE; cy++) {
-      for (int cz = 0; cz < WORLD_DEPTH / CHUNK_SIZE; cz++) {
-        chunks[cx][cy][cz].dirty = true;
-      }
-    }
-  }
-}
+  if (headless)
+    return; // Never loaded any GPU resources
 
-void World::Unload() {
-  for (int i = 1; i < 8; i++) {
-    UnloadTexture(blockTextures[i]);
+  for (int i = 1; i < BLOCK_WATER_FLOW; i++) {
+    UnloadTexture(blockTextures[i]); // Slot 0 is dirt's again
   }
   UnloadTexture(atlasTexture);
+  UnloadShader(chunkShader);
 
-  for (int cx = 0; cx < WORLD_WIDTH / CHUNK_SIZE; cx++) {
-    for (int cy = 0; cy < WORLD_HEIGHT / CHUNK_SIZE; cy++) {
-      for (int cz = 0; cz < WORLD_DEPTH / CHUNK_SIZE; cz++) {
-        if (chunks[cx][cy][cz].active) {
-          if (chunks[cx][cy][cz].model.meshCount > 0) {
-            UnloadModel(chunks[cx][cy][cz].model);
-          }
-        }
-      }
-    }
-  }
+  rlUnloadVertexBuffer(quadIndexBuffer);
 }
 
+// Flowing water looks like a source
 Texture2D World::GetBlockTexture(BlockType type) {
-  if (type < 0 || type > 9)
+  if (type >= BLOCK_TYPE_COUNT)
     return blockTextures[BLOCK_DIRT];
+  if (IsWater(type))
+    return blockTextures[BLOCK_WATER];
   return blockTextures[type];
 }
 
-void World::GenerateTerrain() {
-  // Smoother noise for hills - much lower frequency for "cleaner" look
-  // Increased scale to 200.0f means hills are very wide and gentle.
-  Image noiseMap = GenImagePerlinNoise(WORLD_WIDTH, WORLD_DEPTH, 0, 0, 2.0f);
-  Color *pixels = LoadImageColors(noiseMap);
-
-  Vector2 center = {WORLD_WIDTH / 2.0f, WORLD_DEPTH / 2.0f};
-  float maxDist = WORLD_WIDTH / 2.0f; // Radius
-
-  for (int x = 0; x < WORLD_WIDTH; x++) {
-    for (int z = 0; z < WORLD_DEPTH; z++) {
-      float noiseVal = pixels[z * WORLD_WIDTH + x].r / 255.0f;
+// Terrain for one column. Everything comes from the seed and the block
+// coordinates (no shared image or rand() state), so a column generates the
+// same whatever was generated before it.
+void World::GenerateColumn(ChunkColumn &column) {
+  int x0 = column.cx * CHUNK_SIZE;
+  int z0 = column.cz * CHUNK_SIZE;
+  HashRng rng(seed, column.cx, column.cz);
+  column.trees.clear();
+
+  Vector2 center = {ISLAND_SIZE / 2.0f, ISLAND_SIZE / 2.0f};
+  float maxDist = ISLAND_SIZE / 2.0f; // Radius
+
+  for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+      int x = x0 + lx;
+      int z = z0 + lz;
+      // Smoother noise for hills - much lower frequency for "cleaner" look.
+      // Same scale and mapping to 0-1 as the old GenImagePerlinNoise image.
+      float noiseVal =
+          FbmNoise2D(seed, x * TERRAIN_NOISE_SCALE, z * TERRAIN_NOISE_SCALE,
+                     TERRAIN_NOISE_OCTAVES, 2.0f, 0.5f);
+      noiseVal = (fminf(fmaxf(noiseVal, -1.0f), 1.0f) + 1.0f) / 2.0f;
 
       // ISLAND MASK
       float distBox =
@@ -220,14 +365,15 @@ void World::GenerateTerrain() {
       float dist = (distBox + distCircle) * 0.5f;
 
       float gradient = 1.0f - (dist / maxDist); // 1.0 at center, 0.0 at edge
-      gradient = pow(gradient, 0.5f); // Curve it to keep center flat-ish
-      if (gradient < 0)
-        gradient = 0;
 
-      // Lower height multiplier for flatter terrain
-      // +64 offset ensures deep ground (Sea Level at 64)
-      // Height up to ~120-150.
-      int height = (int)(noiseVal * 60.0f * gradient) + 64;
+      // Past the edge there is only sea, down to the bottom of the world
+      int height = -1;
+      if (gradient >= 0) {
+        gradient = pow(gradient, 0.5f); // Curve it to keep center flat-ish
+        // Lower height multiplier for flatter terrain
+        // +64 offset ensures deep ground (Sea Level at 64)
+        height = (int)(noiseVal * 60.0f * gradient) + 64;
+      }
 
       for (int y = 0; y <= height; y++) {
         BlockType type = BLOCK_DIRT;
@@ -237,571 +383,2091 @@ void World::GenerateTerrain() {
           type = BLOCK_STONE;
         if (y == height && y <= 65) // Sand beaches near water level (64)
           type = BLOCK_SAND;
-
-        SetBlock(x, y, z, true, type);
+        column.chunks[y / CHUNK_SIZE].blocks.Set(lx, y % CHUNK_SIZE, lz, type);
       }
 
       // Water Level at Y=64
-      for (int y = 0; y <= 64; y++) {
-        if (!grid[x][y][z].active) {
-          SetBlock(x, y, z, true, BLOCK_WATER);
-        }
+      for (int y = height + 1; y <= 64; y++)
+        column.chunks[y / CHUNK_SIZE].blocks.Set(lx, y % CHUNK_SIZE, lz,
+                                                 BLOCK_WATER);
+
+      // Trees (Only on Grass and not too close to water). Only recorded
+      // here: DecorateColumn places them once the columns around exist.
+      if (height > 65 && rng.Below(100) < 1) { // 1% chance
+        int treeHeight = 4 + rng.Below(3);
+        if (height + 1 < WORLD_HEIGHT - 8)
+          column.trees.push_back({(uint8_t)lx, (uint8_t)(height + 1),
+                                  (uint8_t)lz, (uint8_t)treeHeight});
       }
+    }
+  }
 
-      // Trees (Only on Grass and not too close to water)
-      if (grid[x][height][z].active && grid[x][height][z].type == BLOCK_GRASS &&
-          height > 65 && (rand() % 100) < 1) { // 1% chance
-        GenerateTree(x, height + 1, z);
+  for (Chunk &chunk : column.chunks)
+    chunk.blocks.Compact(); // Narrowest palette width that fits
+}
+
+// Places every tree rooted in the 3x3 columns around this one, clipped to
+// this column. Only this column is written and the trees come from the
+// neighbours' terrain, so the result is the same whichever columns were
+// generated, decorated or evicted first. Safe on a worker while the map
+// isn't changing (no FindColumn, its cache is main-thread only).
+void World::DecorateColumn(ChunkColumn &column) {
+  for (int dx = -1; dx <= 1; dx++) {
+    for (int dz = -1; dz <= 1; dz++) {
+      const ChunkColumn *source =
+          columns.find(ColumnKey(column.cx + dx, column.cz + dz))->second;
+      for (const TreeSite &tree : source->trees)
+        PlaceTree(column, dx * CHUNK_SIZE + tree.lx,
+                  dz * CHUNK_SIZE + tree.lz, tree);
+    }
+  }
+  for (Chunk &chunk : column.chunks)
+    Blocks(chunk).Compact(); // Trees may have widened a palette
+  LightColumn(column);
+  column.state = COLUMN_READY;
+  column.landState = COLUMN_READY;
+  column.unsaved = true; // Saved again with its trees
+}
+
+// The part of one tree inside the column. (ox, oz) is the trunk in the
+// column's local coordinates and may lie in a neighbour. Leaves only fill
+// air, so a trunk wins over another tree's canopy in either order.
+void World::PlaceTree(ChunkColumn &column, int ox, int oz,
+                      const TreeSite &tree) {
+  int y = tree.y;
+  int top = tree.y + tree.height;
+  if (ox >= 0 && ox < CHUNK_SIZE && oz >= 0 && oz < CHUNK_SIZE) {
+    for (int ty = y; ty < top; ty++)
+      Blocks(column.chunks[ty / CHUNK_SIZE])
+          .Set(ox, ty % CHUNK_SIZE, oz, BLOCK_WOOD);
+  }
+
+  for (int tx = std::max(ox - 2, 0); tx <= std::min(ox + 2, CHUNK_SIZE - 1);
+       tx++) {
+    for (int tz = std::max(oz - 2, 0);
+         tz <= std::min(oz + 2, CHUNK_SIZE - 1); tz++) {
+      for (int ty = top - 2; ty <= top + 1; ty++) {
+        if (abs(tx - ox) + abs(ty - top) + abs(tz - oz) <= 3) {
+          ChunkSection &blocks = Blocks(column.chunks[ty / CHUNK_SIZE]);
+          if (blocks.Get(tx, ty % CHUNK_SIZE, tz) == BLOCK_AIR)
+            blocks.Set(tx, ty % CHUNK_SIZE, tz, BLOCK_LEAVES);
+        }
       }
     }
   }
-  UnloadImageColors(pixels);
-  UnloadImage(noiseMap);
 }
 
-void World::GenerateTree(int x, int y, int z) {
-  if (x < 2 || x >= WORLD_WIDTH - 2 || z < 2 || z >= WORLD_DEPTH - 2 ||
-      y >= WORLD_HEIGHT - 8)
-    return;
-  int treeHeight = 4 + rand() % 3;
-  for (int i = 0; i < treeHeight; i++)
-    SetBlock(x, y + i, z, true, BLOCK_WOOD);
-
-  for (int lx = x - 2; lx <= x + 2; lx++) {
-    for (int lz = z - 2; lz <= z + 2; lz++) {
-      for (int ly = y + treeHeight - 2; ly <= y + treeHeight + 1; ly++) {
-        if (abs(lx - x) + abs(ly - (y + treeHeight)) + abs(lz - z) <= 3) {
-          if (!grid[lx][ly][lz].active)
-            SetBlock(lx, ly, lz, true, BLOCK_LEAVES);
+// Neighbour offsets in ChunkFace order
+static const int LIGHT_STEP[CHUNK_FACE_COUNT][3] = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+// The faces a column shares with its neighbours
+static const int COLUMN_SIDES[4] = {CHUNK_FACE_NEG_X, CHUNK_FACE_POS_X,
+                                    CHUNK_FACE_NEG_Z, CHUNK_FACE_POS_Z};
+
+// Level light at `level` reaches a neighbour with the given opacity in
+// direction `face`. Full sky light keeps going straight down through air.
+static inline int LightStep(int channel, int face, int level, int opacity) {
+  if (channel == LIGHT_SKY && face == CHUNK_FACE_NEG_Y &&
+      level == LIGHT_MAX && opacity == 0)
+    return LIGHT_MAX;
+  return level - 1 - opacity;
+}
+
+// A block's index in its chunk's sections
+static inline int LightIndex(int x, int y, int z) {
+  return ChunkSection::Index(BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z));
+}
+
+// What a LIGHT_STEP adds to the index, staying in the chunk
+static const int LIGHT_INDEX_STEP[CHUNK_FACE_COUNT] = {
+    -1, 1, -CHUNK_SIZE * CHUNK_SIZE, CHUNK_SIZE * CHUNK_SIZE, -CHUNK_SIZE,
+    CHUNK_SIZE};
+
+// Whether a step from the block in direction `face` leaves its chunk
+static inline bool StepLeavesChunk(int x, int y, int z, int face) {
+  int local[3] = {BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z)};
+  return local[face / 2] == (face % 2 ? CHUNK_SIZE - 1 : 0);
+}
+
+// Whether the block lies on one of its chunk's faces
+static inline bool OnChunkFace(int x, int y, int z) {
+  int local[3] = {BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z)};
+  for (int l : local)
+    if (l == 0 || l == CHUNK_SIZE - 1)
+      return true;
+  return false;
+}
+
+// Light of a column as if the columns around were solid: open shafts of full
+// sky light down to the first block that isn't air, then a breadth-first
+// spread from the shaft cells beside something lower, and from blocks giving
+// off light. JoinColumnLight lets it across the borders later. Only writes
+// this column, so it runs on whichever thread finished the column. Mapped
+// sections are read through a scratch copy and stay undecoded.
+void World::LightColumn(ChunkColumn &column) {
+  thread_local ChunkSection scratch[WORLD_COLUMN_CHUNKS];
+  thread_local std::vector<int> queue; // Column-local cells
+  const ChunkSection *sections[WORLD_COLUMN_CHUNKS];
+  for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+    Chunk &chunk = column.chunks[cy];
+    sections[cy] = &chunk.blocks;
+    if (chunk.encoded) {
+      scratch[cy].Decode(chunk.encoded, chunk.encodedSize);
+      sections[cy] = &scratch[cy];
+    }
+  }
+  auto opacity = [&](int lx, int y, int lz) {
+    return BlockLightOpacity(
+        sections[y / CHUNK_SIZE]->Get(lx, y % CHUNK_SIZE, lz));
+  };
+
+  // Bottom of each open shaft, skipping whole sections of air at a time
+  int shaft[CHUNK_SIZE][CHUNK_SIZE];
+  int lowest = WORLD_HEIGHT, highest = 0;
+  for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+      int y = WORLD_HEIGHT;
+      while (y > 0) {
+        const ChunkSection *s = sections[(y - 1) / CHUNK_SIZE];
+        if (y % CHUNK_SIZE == 0 && s->IsUniform() &&
+            BlockLightOpacity(s->GetUniformType()) == 0)
+          y -= CHUNK_SIZE;
+        else if (opacity(lx, y - 1, lz) == 0)
+          y--;
+        else
+          break;
+      }
+      shaft[lx][lz] = y;
+      lowest = std::min(lowest, y);
+      highest = std::max(highest, y);
+    }
+  }
+
+  for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+    Chunk &chunk = column.chunks[cy];
+    int y0 = cy * CHUNK_SIZE;
+    chunk.blockLight.Fill(0);
+    chunk.skyLight.Fill(y0 >= highest ? LIGHT_MAX : 0);
+    if (y0 >= highest || y0 + CHUNK_SIZE <= lowest)
+      continue;
+    for (int lx = 0; lx < CHUNK_SIZE; lx++)
+      for (int lz = 0; lz < CHUNK_SIZE; lz++)
+        for (int y = std::max(shaft[lx][lz], y0); y < y0 + CHUNK_SIZE; y++)
+          chunk.skyLight.Set(ChunkSection::Index(lx, y - y0, lz), LIGHT_MAX);
+  }
+
+  auto spread = [&](int channel) {
+    for (size_t head = 0; head < queue.size(); head++) {
+      int cell = queue[head];
+      int lx = cell % CHUNK_SIZE, lz = cell / CHUNK_SIZE % CHUNK_SIZE;
+      int y = cell / (CHUNK_SIZE * CHUNK_SIZE);
+      int level = Light(column.chunks[y / CHUNK_SIZE], channel)
+                      .Get(cell % CHUNK_VOLUME);
+      for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+        int nx = lx + LIGHT_STEP[face][0];
+        int ny = y + LIGHT_STEP[face][1];
+        int nz = lz + LIGHT_STEP[face][2];
+        if (nx < 0 || nx >= CHUNK_SIZE || ny < 0 || ny >= WORLD_HEIGHT ||
+            nz < 0 || nz >= CHUNK_SIZE)
+          continue;
+        int reach = LightStep(channel, face, level, opacity(nx, ny, nz));
+        int next = (ny * CHUNK_SIZE + nz) * CHUNK_SIZE + nx;
+        LightSection &light = Light(column.chunks[ny / CHUNK_SIZE], channel);
+        if (reach > light.Get(next % CHUNK_VOLUME)) {
+          light.Set(next % CHUNK_VOLUME, reach);
+          queue.push_back(next);
         }
       }
     }
+    queue.clear();
+  };
+
+  // Sky light spreads sideways from the shaft cells level with a lower
+  // neighbour's blocks, and down from each shaft's bottom
+  for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+      int top = shaft[lx][lz] + 1;
+      for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+        int nx = lx + LIGHT_STEP[face][0], nz = lz + LIGHT_STEP[face][2];
+        if (LIGHT_STEP[face][1] == 0 && nx >= 0 && nx < CHUNK_SIZE &&
+            nz >= 0 && nz < CHUNK_SIZE)
+          top = std::max(top, shaft[nx][nz]);
+      }
+      for (int y = shaft[lx][lz]; y < std::min(top, WORLD_HEIGHT); y++)
+        queue.push_back((y * CHUNK_SIZE + lz) * CHUNK_SIZE + lx);
+    }
+  }
+  spread(LIGHT_SKY);
+
+  // Lamps are the only blocks that give off light
+  for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+    if (!sections[cy]->Contains(BLOCK_LAMP))
+      continue;
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+      int lx = i % CHUNK_SIZE, lz = i / CHUNK_SIZE % CHUNK_SIZE;
+      int ly = i / (CHUNK_SIZE * CHUNK_SIZE);
+      int level = BlockLightEmission(sections[cy]->Get(lx, ly, lz));
+      if (level > 0) {
+        column.chunks[cy].blockLight.Set(i, level);
+        queue.push_back(cy * CHUNK_VOLUME + i);
+      }
+    }
+  }
+  spread(LIGHT_BLOCK);
+
+  for (Chunk &chunk : column.chunks) {
+    chunk.skyLight.Compact();
+    chunk.blockLight.Compact();
   }
 }
 
-// Update with player pos? Actually we only need it for prioritizing chunks.
-// For now, simple round robin is fine or distance check.
-void World::Update(Vector3 playerPos) {
-  int rebuildCount = 0;
-
-  // Prioritize chunks near player?
-  // Simple scan
-  int cxStart = (int)playerPos.x / CHUNK_SIZE - 4;
-  int cxEnd = (int)playerPos.x / CHUNK_SIZE + 4;
-  int czStart = (int)playerPos.z / CHUNK_SIZE - 4;
-  int czEnd = (int)playerPos.z / CHUNK_SIZE + 4;
-
-  // Clamp
-  if (cxStart < 0)
-    cxStart = 0;
-  if (cxEnd > WORLD_WIDTH / CHUNK_SIZE)
-    cxEnd = WORLD_WIDTH / CHUNK_SIZE;
-  if (czStart < 0)
-    czStart = 0;
-  if (czEnd > WORLD_WIDTH / CHUNK_SIZE)
-    czEnd = WORLD_WIDTH / CHUNK_SIZE; // Depth same as width logic
-
-  for (int cx = cxStart; cx < cxEnd; cx++) {
-    for (int cz = czStart; cz < czEnd; cz++) {
-      for (int cy = 0; cy < WORLD_HEIGHT / CHUNK_SIZE; cy++) {
-        if (chunks[cx][cy][cz].dirty) {
-          RebuildChunk(cx, cy, cz);
-          rebuildCount++;
-          if (rebuildCount > 4) // Lower rebuild per frame to keep FPS high
-            return;
+// Lets light across the column's four sides, both ways, where the
+// neighbour is READY too: any cell brighter than the one across by more
+// than a step seeds the spread. Saved light was joined with what was around
+// at the time, and a side marked stale changed since (a lamp taken out next
+// door while this column was unloaded), so there a lit border cell that
+// nothing lights any more is put out first, with everything it lit. Main
+// thread.
+void World::JoinColumnLight(ChunkColumn &column) {
+  int x0 = column.cx * CHUNK_SIZE, z0 = column.cz * CHUNK_SIZE;
+  for (int channel = LIGHT_SKY; channel <= LIGHT_BLOCK; channel++) {
+    // Puts out a border cell if its light has no source left. One far
+    // dimmer than the cell across is lit from there, whatever it holds.
+    auto check = [&](Chunk &chunk, LightSection &light, int i, int x, int y,
+                     int z, int across) {
+      int level = light.Get(i);
+      if (level == 0 || across - 1 - 2 >= level ||
+          IsLightSupported(chunk, channel, x, y, z, level))
+        return false;
+      lightRemoveQueue.push_back({x, y, z, level});
+      light.Set(i, 0);
+      MarkLightChanged(chunk, x, y, z, false);
+      return true;
+    };
+    for (int side : COLUMN_SIDES) {
+      int dx = LIGHT_STEP[side][0], dz = LIGHT_STEP[side][2];
+      ChunkColumn *other = FindColumn(column.cx + dx, column.cz + dz);
+      if (!other || other->state != COLUMN_READY)
+        continue;
+      bool stale = other->staleSides & 1 << (side ^ 1) ||
+                   column.staleSides & 1 << side;
+      if (channel == LIGHT_BLOCK) {
+        other->staleSides &= ~(1 << (side ^ 1));
+        column.staleSides &= ~(1 << side);
+      }
+      // Saved beside each other and neither changed since: they agree
+      if (column.joinedSides & 1 << side && !stale)
+        continue;
+      for (int cy = 0; cy < WORLD_COLUMN_CHUNKS; cy++) {
+        LightSection &inside = Light(column.chunks[cy], channel);
+        LightSection &outside = Light(other->chunks[cy], channel);
+        // Evenly lit on both sides, open sky or dark rock. Stale light
+        // fades with distance, so is never even.
+        if (inside.IsUniform() && outside.IsUniform() &&
+            abs(inside.GetUniformLevel() - outside.GetUniformLevel()) <= 1)
+          continue;
+        for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+          for (int along = 0; along < CHUNK_SIZE; along++) {
+            // The border cell on this side and the one across
+            int lx = dx < 0 ? 0 : dx > 0 ? CHUNK_SIZE - 1 : along;
+            int lz = dz < 0 ? 0 : dz > 0 ? CHUNK_SIZE - 1 : along;
+            int ia = ChunkSection::Index(lx, ly, lz);
+            int ib = ChunkSection::Index(BlockToLocal(lx + dx), ly,
+                                         BlockToLocal(lz + dz));
+            int y = cy * CHUNK_SIZE + ly;
+            int a = inside.Get(ia), b = outside.Get(ib);
+            if (stale &&
+                (check(column.chunks[cy], inside, ia, x0 + lx, y, z0 + lz, b) |
+                 check(other->chunks[cy], outside, ib, x0 + lx + dx, y,
+                       z0 + lz + dz, a)))
+              continue;
+            if (a > b + 1)
+              lightAddQueue.push_back({x0 + lx, y, z0 + lz, a});
+            else if (b > a + 1)
+              lightAddQueue.push_back({x0 + lx + dx, y, z0 + lz + dz, b});
+          }
         }
       }
     }
+    UnspreadLight(channel, false);
+    SpreadLight(channel, false);
   }
 }
 
-// Rebuilds a specific chunk mesh
-void World::RebuildChunk(int cx, int cy, int cz) {
-  Chunk &chunk = chunks[cx][cy][cz];
+// Whether a lit cell's level still has a source: its own block, open sky
+// straight above, or a neighbour bright enough to reach it. The block is
+// only looked at (and a mapped section decoded) when the levels around
+// don't settle it; a lit block lets light in, so loses at most 2 to it.
+bool World::IsLightSupported(Chunk &chunk, int channel, int x, int y, int z,
+                             int level) {
+  int index = LightIndex(x, y, z);
+  int around[CHUNK_FACE_COUNT]; // Level of the cell a step in face comes from
+  int brightest = 0;
+  for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+    int back = face ^ 1;
+    int nx = x + LIGHT_STEP[back][0];
+    int ny = y + LIGHT_STEP[back][1];
+    int nz = z + LIGHT_STEP[back][2];
+    bool leaves = StepLeavesChunk(x, y, z, back);
+    Chunk *from = leaves ? FindLitChunk(nx, ny, nz) : &chunk;
+    around[face] = 0;
+    if (from)
+      around[face] = Light(*from, channel)
+                         .Get(leaves ? LightIndex(nx, ny, nz)
+                                     : index + LIGHT_INDEX_STEP[back]);
+    else if (channel == LIGHT_SKY && ny == WORLD_HEIGHT)
+      around[face] = LIGHT_MAX; // Open sky over the top
+    brightest = std::max(brightest, around[face]);
+  }
+  // Full sky light only falls straight down, through air
+  if (channel == LIGHT_SKY && level == LIGHT_MAX)
+    return around[CHUNK_FACE_NEG_Y] == LIGHT_MAX;
+  if (brightest - 1 - 2 >= level)
+    return true;
+  if (channel == LIGHT_SKY && brightest - 1 < level)
+    return false;
+  BlockType type =
+      Blocks(chunk).Get(BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z));
+  if (channel == LIGHT_BLOCK && BlockLightEmission(type) >= level)
+    return true;
+  for (int face = 0; face < CHUNK_FACE_COUNT; face++)
+    if (LightStep(channel, face, around[face], BlockLightOpacity(type)) >=
+        level)
+      return true;
+  return false;
+}
 
-  // Cleanup old model
-  if (chunk.active) {
-    UnloadModel(chunk.model);
-    chunk.active = false;
-    chunk.model = {0};
+void World::JoinQueuedLight() {
+  for (ChunkColumn *column : joinQueue)
+    JoinColumnLight(*column);
+  joinQueue.clear();
+}
+
+// Chunk holding a block in a READY column, else null. Light only goes
+// through finished columns; the rest get theirs when they join.
+Chunk *World::FindLitChunk(int x, int y, int z) {
+  if (y < 0 || y >= WORLD_HEIGHT)
+    return nullptr;
+  ChunkColumn *column = FindColumn(BlockToChunk(x), BlockToChunk(z));
+  if (!column || column->state != COLUMN_READY)
+    return nullptr;
+  return &column->chunks[y / CHUNK_SIZE];
+}
+
+// Notes a block for RelightQueued if the change matters to light, and says
+// whether it did. The node's level records whether light can now get in
+// further than before.
+bool World::QueueRelight(int x, int y, int z, BlockType before,
+                         BlockType after) {
+  if (BlockLightOpacity(before) == BlockLightOpacity(after) &&
+      BlockLightEmission(before) == BlockLightEmission(after))
+    return false; // Stone to dirt, say: light passes just the same
+  relightCells.push_back(
+      {x, y, z, BlockLightOpacity(after) < BlockLightOpacity(before)});
+  return true;
+}
+
+// Per channel: puts out the queued cells and everything they lit, then
+// lets the light around the dark area, and the cells' own, spread back in
+void World::RelightQueued(bool edited) {
+  relightCellCount = 0;
+  if (relightCells.empty())
+    return;
+  for (int channel = LIGHT_SKY; channel <= LIGHT_BLOCK; channel++) {
+    for (const LightNode &cell : relightCells) {
+      Chunk *chunk = FindLitChunk(cell.x, cell.y, cell.z);
+      if (!chunk)
+        continue;
+      LightSection &light = Light(*chunk, channel);
+      int i = LightIndex(cell.x, cell.y, cell.z);
+      // A dark cell that got no clearer has nothing to put out or let in,
+      // nor has one with nothing but dark around it
+      if (light.Get(i) == 0 &&
+          (!cell.level || (light.IsUniform() &&
+                           !OnChunkFace(cell.x, cell.y, cell.z))))
+        continue;
+      lightRemoveQueue.push_back({cell.x, cell.y, cell.z, light.Get(i)});
+      if (light.Get(i) != 0) {
+        light.Set(i, 0);
+        MarkLightChanged(*chunk, cell.x, cell.y, cell.z, edited);
+      }
+    }
+    relightCellCount += UnspreadLight(channel, edited);
+
+    for (const LightNode &cell : relightCells) {
+      Chunk *chunk = FindLitChunk(cell.x, cell.y, cell.z);
+      if (!chunk)
+        continue;
+      int i = LightIndex(cell.x, cell.y, cell.z);
+      BlockType type = Blocks(*chunk).Get(BlockToLocal(cell.x),
+                                          cell.y % CHUNK_SIZE,
+                                          BlockToLocal(cell.z));
+      int level = BlockLightEmission(type);
+      if (channel == LIGHT_SKY)
+        level = cell.y == WORLD_HEIGHT - 1 && BlockLightOpacity(type) == 0
+                    ? LIGHT_MAX
+                    : 0;
+      LightSection &light = Light(*chunk, channel);
+      if (level > light.Get(i)) {
+        light.Set(i, level);
+        MarkLightChanged(*chunk, cell.x, cell.y, cell.z, edited);
+        lightAddQueue.push_back({cell.x, cell.y, cell.z, level});
+      }
+    }
+    relightCellCount += SpreadLight(channel, edited);
   }
-  chunk.dirty = false;
+  relightCells.clear();
+}
 
-  // Geometry Generation
-  // Arrays for mesh construction
-  // Estimate size? 16*16*16 * 6 faces * 6 verts = 24k verts max.
-  // std::vector is fine.
-  std::vector<Vector3> vertices;
-  std::vector<Vector2> texcoords;
-  std::vector<Vector3> normals;
-
-  int startX = cx * CHUNK_SIZE;
-  int startY = cy * CHUNK_SIZE;
-  int startZ = cz * CHUNK_SIZE;
-  int endX = startX + CHUNK_SIZE;
-  int endY = startY + CHUNK_SIZE;
-  int endZ = startZ + CHUNK_SIZE;
-
-  if (endX > WORLD_WIDTH)
-    endX = WORLD_WIDTH;
-  if (endY > WORLD_HEIGHT)
-    endY = WORLD_HEIGHT;
-  if (endZ > WORLD_DEPTH)
-    endZ = WORLD_DEPTH;
-
-  // Unit size UV
-  float uvStep = 1.0f / 8.0f; // 8 blocks matches width 128 (16px * 8)
-
-  for (int x = startX; x < endX; x++) {
-    for (int y = startY; y < endY; y++) {
-      for (int z = startZ; z < endZ; z++) {
-        if (!grid[x][y][z].active)
+// FillBox's relight when the type lets light straight through (air) or stops
+// it, and gives off none. Inside the box the light is written directly, a
+// whole section at a time where the box covers it, and only the cells on
+// the box's faces go through the queues: light gets in or out of the box
+// across those alone. The blocks are filled already.
+void World::RelightFilledBox(int x0, int y0, int z0, int x1, int y1, int z1,
+                             BlockType type) {
+  bool open = BlockLightOpacity(type) == 0;
+  relightCellCount = 0;
+  // Calls visit(chunk, x, y, z) for every cell of the box in a READY column
+  // if all, else just the ones on its faces
+  auto forEachCell = [&](bool all, auto visit) {
+    for (int cx = BlockToChunk(x0); cx <= BlockToChunk(x1); cx++) {
+      for (int cz = BlockToChunk(z0); cz <= BlockToChunk(z1); cz++) {
+        ChunkColumn *column = FindColumn(cx, cz);
+        if (!column || column->state != COLUMN_READY)
           continue;
-
-        BlockType type = grid[x][y][z].type;
-
-        // Default UVs (everything same on all sides)
-        float uTop = (int)type * uvStep;
-        float vTop = 0.0f;
-        float uBottom = uTop;
-        float vBottom = 0.0f;
-        float uSide = uTop;
-        float vSide = 0.0f;
-
-        // Custom Multi-Face Textures
-        if (type == BLOCK_GRASS) {
-          uTop = 2 * uvStep;
-          vTop = 0.0f; // Grass Top
-          uBottom = 1 * uvStep;
-          vBottom = 0.0f; // Dirt Bottom
-          uSide = 2 * uvStep;
-          vSide = uvStep; // Grass Side (Row 1)
-        } else if (type == BLOCK_WOOD) {
-          uTop = 4 * uvStep;
-          vTop = uvStep; // Wood Top (Row 1)
-          uBottom = 4 * uvStep;
-          vBottom = uvStep;
-          uSide = 4 * uvStep;
-          vSide = 0.0f; // Wood Side
+        int bx0 = std::max(x0, cx * CHUNK_SIZE);
+        int bx1 = std::min(x1, cx * CHUNK_SIZE + CHUNK_SIZE - 1);
+        int bz0 = std::max(z0, cz * CHUNK_SIZE);
+        int bz1 = std::min(z1, cz * CHUNK_SIZE + CHUNK_SIZE - 1);
+        for (int y = y0; y <= y1; y++) {
+          Chunk &chunk = column->chunks[y / CHUNK_SIZE];
+          for (int z = bz0; z <= bz1; z++) {
+            if (all || y == y0 || y == y1 || z == z0 || z == z1) {
+              for (int x = bx0; x <= bx1; x++)
+                visit(chunk, x, y, z);
+            } else {
+              if (bx0 == x0)
+                visit(chunk, x0, y, z);
+              if (bx1 == x1 && x1 != x0)
+                visit(chunk, x1, y, z);
+            }
+          }
         }
-
-        // Check neighbors
-        // TOP (Y+)
-        if (y == WORLD_HEIGHT - 1 || !grid[x][y + 1][z].active ||
-            (grid[x][y + 1][z].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          // Add Top Face
-          vertices.push_back((Vector3){(float)x, (float)y + 1, (float)z}); // TL
-          vertices.push_back(
-              (Vector3){(float)x, (float)y + 1, (float)z + 1}); // BL
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z + 1}); // BR
-
-          vertices.push_back((Vector3){(float)x, (float)y + 1, (float)z}); // TL
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z + 1}); // BR
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z}); // TR
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){0, 1, 0});
-
-          float u = uTop;
-          float v = vTop;
-          float vH = 0.125f;
-          float uW = 0.125f;
-
-          // Fix UVs to match vertices order
-          // TL, BL, BR, TL, BR, TR
-          // texcoords.pop_back(); // These lines were part of a previous fix,
-          // no longer needed texcoords.pop_back(); // Remove placeholder
-
-          texcoords.push_back((Vector2){u, v});           // TL
-          texcoords.push_back((Vector2){u, v + vH});      // BL
-          texcoords.push_back((Vector2){u + uW, v + vH}); // BR
-
-          texcoords.push_back((Vector2){u, v});           // TL
-          texcoords.push_back((Vector2){u + uW, v + vH}); // BR
-          texcoords.push_back((Vector2){u + uW, v});      // TR
+      }
+    }
+  };
+
+  for (int channel = LIGHT_SKY; channel <= LIGHT_BLOCK; channel++) {
+    // Put out the light the faces had, then clear the rest of the box
+    forEachCell(false, [&](Chunk &chunk, int x, int y, int z) {
+      LightSection &light = Light(chunk, channel);
+      int i = LightIndex(x, y, z);
+      if (light.Get(i) != 0) {
+        lightRemoveQueue.push_back({x, y, z, light.Get(i)});
+        light.Set(i, 0);
+      }
+    });
+    for (int cx = BlockToChunk(x0); cx <= BlockToChunk(x1); cx++) {
+      for (int cz = BlockToChunk(z0); cz <= BlockToChunk(z1); cz++) {
+        ChunkColumn *column = FindColumn(cx, cz);
+        if (!column || column->state != COLUMN_READY)
+          continue;
+        int lx0 = std::max(x0 - cx * CHUNK_SIZE, 0);
+        int lx1 = std::min(x1 - cx * CHUNK_SIZE, CHUNK_SIZE - 1);
+        int lz0 = std::max(z0 - cz * CHUNK_SIZE, 0);
+        int lz1 = std::min(z1 - cz * CHUNK_SIZE, CHUNK_SIZE - 1);
+        for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; cy++) {
+          int ly0 = std::max(y0 - cy * CHUNK_SIZE, 0);
+          int ly1 = std::min(y1 - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+          LightSection &light = Light(column->chunks[cy], channel);
+          if (light.IsUniform() && light.GetUniformLevel() == 0)
+            continue;
+          if (lx0 == 0 && ly0 == 0 && lz0 == 0 && lx1 == CHUNK_SIZE - 1 &&
+              ly1 == CHUNK_SIZE - 1 && lz1 == CHUNK_SIZE - 1) {
+            light.Fill(0);
+            continue;
+          }
+          for (int ly = ly0; ly <= ly1; ly++)
+            for (int lz = lz0; lz <= lz1; lz++)
+              for (int lx = lx0; lx <= lx1; lx++)
+                light.Set(ChunkSection::Index(lx, ly, lz), 0);
+          light.Compact();
         }
+      }
+    }
+    relightCellCount += UnspreadLight(channel, true);
+    if (!open) {
+      // Nothing gets into an opaque box, only around it
+      relightCellCount += SpreadLight(channel, true);
+      continue;
+    }
 
-        // BOTTOM (Y-)
-        if (y == 0 || !grid[x][y - 1][z].active ||
-            (grid[x][y - 1][z].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z + 1});
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z});
-          vertices.push_back((Vector3){(float)x + 1, (float)y, (float)z});
-
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z + 1});
-          vertices.push_back((Vector3){(float)x + 1, (float)y, (float)z});
-          vertices.push_back((Vector3){(float)x + 1, (float)y, (float)z + 1});
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){0, -1, 0});
-
-          float u = uBottom; // Use Bottom Texture
-          float v = vBottom;
-          float vH = 0.125f;
-          float uW = 0.125f;
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u, v});
-          texcoords.push_back((Vector2){u + uW, v});
-
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u + uW, v});
-          texcoords.push_back((Vector2){u + uW, v + vH});
+    // Sky light falls straight through wherever full sky is above the box.
+    // Shafts beside one that isn't spread sideways into it.
+    if (channel == LIGHT_SKY) {
+      int sizeX = x1 - x0 + 1, sizeZ = z1 - z0 + 1;
+      boxShafts.assign((size_t)sizeX * sizeZ, 0);
+      for (int x = x0; x <= x1; x++) {
+        for (int z = z0; z <= z1; z++) {
+          Chunk *above = FindLitChunk(x, y1 + 1, z);
+          if (y1 == WORLD_HEIGHT - 1
+                  ? FindLitChunk(x, y1, z) != nullptr
+                  : above && above->skyLight.Get(LightIndex(x, y1 + 1, z)) ==
+                                 LIGHT_MAX)
+            boxShafts[(x - x0) * sizeZ + (z - z0)] = 1;
         }
-
-        // FRONT (Z+) - Face Normal (0, 0, 1)
-        if (z == WORLD_DEPTH - 1 || !grid[x][y][z + 1].active ||
-            (grid[x][y][z + 1].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          // CCW winding: BL -> TR -> TL
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z + 1}); // BL
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z + 1}); // TR
-          vertices.push_back(
-              (Vector3){(float)x, (float)y + 1, (float)z + 1}); // TL
-
-          // CCW winding: BL -> BR -> TR
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z + 1}); // BL
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y, (float)z + 1}); // BR
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z + 1}); // TR
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){0, 0, 1});
-
-          float u = uSide; // Side Texture
-          float v = vSide;
-          float vH = 0.125f;
-          float uW = 0.125f;
-          // UVs must match vertex order:
-          // BL(u, v+vH), TR(u+uW, v), TL(u, v)
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u + uW, v});
-          texcoords.push_back((Vector2){u, v});
-
-          // BL(u, v+vH), BR(u+uW, v+vH), TR(u+uW, v)
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u + uW, v});
+      }
+      auto shaft = [&](int x, int z) {
+        return x < x0 || x > x1 || z < z0 || z > z1 ||
+               boxShafts[(x - x0) * sizeZ + (z - z0)];
+      };
+      for (int cx = BlockToChunk(x0); cx <= BlockToChunk(x1); cx++) {
+        for (int cz = BlockToChunk(z0); cz <= BlockToChunk(z1); cz++) {
+          ChunkColumn *column = FindColumn(cx, cz);
+          if (!column || column->state != COLUMN_READY)
+            continue;
+          int bx0 = std::max(x0, cx * CHUNK_SIZE);
+          int bx1 = std::min(x1, cx * CHUNK_SIZE + CHUNK_SIZE - 1);
+          int bz0 = std::max(z0, cz * CHUNK_SIZE);
+          int bz1 = std::min(z1, cz * CHUNK_SIZE + CHUNK_SIZE - 1);
+          bool whole =
+              bx1 - bx0 == CHUNK_SIZE - 1 && bz1 - bz0 == CHUNK_SIZE - 1;
+          for (int x = bx0; x <= bx1 && whole; x++)
+            for (int z = bz0; z <= bz1 && whole; z++)
+              whole = shaft(x, z);
+          for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; cy++) {
+            int ly0 = std::max(y0 - cy * CHUNK_SIZE, 0);
+            int ly1 = std::min(y1 - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+            LightSection &light = column->chunks[cy].skyLight;
+            bool filled = whole && ly0 == 0 && ly1 == CHUNK_SIZE - 1;
+            if (filled)
+              light.Fill(LIGHT_MAX);
+            for (int x = bx0; x <= bx1; x++) {
+              for (int z = bz0; z <= bz1; z++) {
+                if (!shaft(x, z))
+                  continue;
+                bool edge = !shaft(x - 1, z) || !shaft(x + 1, z) ||
+                            !shaft(x, z - 1) || !shaft(x, z + 1);
+                for (int y = cy * CHUNK_SIZE + ly0;
+                     y <= cy * CHUNK_SIZE + ly1; y++) {
+                  if (!filled)
+                    light.Set(LightIndex(x, y, z), LIGHT_MAX);
+                  if (edge)
+                    lightAddQueue.push_back({x, y, z, LIGHT_MAX});
+                }
+              }
+            }
+          }
         }
+      }
+    }
 
-        // BACK (Z-) - Face Normal (0, 0, -1)
-        if (z == 0 || !grid[x][y][z - 1].active ||
-            (grid[x][y][z - 1].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          // CCW: BR -> BL -> TL (Viewed from back, x+ is Left)
-          // Vertices at Z:
-          // BR (x, y, z)
-          // BL (x+1, y, z)
-          // TL (x+1, y+1, z)
-          // TR (x, y+1, z)
-          // Code uses:
-          // Triangle 1: BL(x+1,y) -> TL(x+1,y+1) -> TR(x,y+1) was giving CW
-          // Need CCW from Z- view. Z- points to us.
-          // X goes Right -> Left on screen.
-          // (x+1, y, z) -> (x, y+1, z) -> (x+1, y+1, z)
-          // Vector 1: (-1, 1). Vector 2: (0, 1). Cross (-1,1,0)x(0,1,0) =
-          // k(-1). (0,0,-1). Correct.
-
-          vertices.push_back((Vector3){(float)x + 1, (float)y,
-                                       (float)z}); // BL (relative to camera)
-          vertices.push_back((Vector3){(float)x, (float)y + 1, (float)z}); // TR
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z}); // TL
-
-          vertices.push_back((Vector3){(float)x + 1, (float)y, (float)z}); // BL
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z});     // BR
-          vertices.push_back((Vector3){(float)x, (float)y + 1, (float)z}); // TR
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){0, 0, -1});
-
-          float u = uSide; // Side Texture
-          float v = vSide;
-          float vH = 0.125f;
-          float uW = 0.125f;
-          // Map UVs to match vertices
-          // (x+1, y)   is u+uW, v+vH
-          // (x, y+1)   is u, v
-          // (x+1, y+1) is u+uW, v
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u, v});
-          texcoords.push_back((Vector2){u + uW, v});
-
-          // (x+1, y) is u+uW, v+vH
-          // (x, y)   is u, v+vH
-          // (x, y+1) is u, v
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u, v});
-        }
+    // Then spread from the lit faces, and in from the cells around the box
+    forEachCell(false, [&](Chunk &chunk, int x, int y, int z) {
+      int level = Light(chunk, channel).Get(LightIndex(x, y, z));
+      if (level > 0)
+        lightAddQueue.push_back({x, y, z, level});
+      for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+        int nx = x + LIGHT_STEP[face][0];
+        int ny = y + LIGHT_STEP[face][1];
+        int nz = z + LIGHT_STEP[face][2];
+        if (nx >= x0 && nx <= x1 && ny >= y0 && ny <= y1 && nz >= z0 &&
+            nz <= z1)
+          continue;
+        Chunk *next = StepLeavesChunk(x, y, z, face) ? FindLitChunk(nx, ny, nz)
+                                                     : &chunk;
+        if (!next)
+          continue;
+        int outside = Light(*next, channel).Get(LightIndex(nx, ny, nz));
+        if (outside > 1)
+          lightAddQueue.push_back({nx, ny, nz, outside});
+      }
+    });
+    relightCellCount += SpreadLight(channel, true);
+  }
+}
 
-        // LEFT (X-) - Face Normal (-1, 0, 0)
-        if (x == 0 || !grid[x - 1][y][z].active ||
-            (grid[x - 1][y][z].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          // Looking from -X. positive Z is Right.
-          // Vertices at x:
-          // BL(z, y) -> (z, y+1) -> (z+1, y+1) was giving CW.
-          // Need CCW.
-          // (z, y) -> (z+1, y+1) -> (z, y+1)
-          // Vector 1: (1, 1). Vector 2: (0, 1). Cross (1,1,0)x(0,1,0) = k(1) =
-          // (1, 0, 0). Wait, we need (-1,0,0). So we want result to coincide
-          // with -X. Actually, in 3D: (0, dy1, dz1) x (0, dy2, dz2). BL->TR:
-          // (0, 1, 1). BL->TL: (0, 1, 0). | i j k | | 0 1 1 | | 0 1 0 | i( -1 )
-          // - ... = (-1, 0, 0). So (z,y)->(z+1,y+1)->(z,y+1) gives (-1, 0, 0).
-          // This is CORRECT.
-
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z}); // BL
-          vertices.push_back(
-              (Vector3){(float)x, (float)y + 1, (float)z + 1});            // TR
-          vertices.push_back((Vector3){(float)x, (float)y + 1, (float)z}); // TL
-
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z});     // BL
-          vertices.push_back((Vector3){(float)x, (float)y, (float)z + 1}); // BR
-          vertices.push_back(
-              (Vector3){(float)x, (float)y + 1, (float)z + 1}); // TR
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){-1, 0, 0});
-
-          float u = uSide; // Side Texture
-          float v = vSide;
-          float vH = 0.125f;
-          float uW = 0.125f;
-          // UV:
-          // BL(x, y, z) -> u, v+vH
-          // TR(x, y+1, z+1) -> u+uW, v
-          // TL(x, y+1, z) -> u, v
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u + uW, v});
-          texcoords.push_back((Vector2){u, v});
-
-          // BL -> u, v+vH
-          // BR(x, y, z+1) -> u+uW, v+vH
-          // TR -> u+uW, v
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u + uW, v});
-        }
+// Breadth-first from the queued cells: each raises its neighbours to the
+// level it can reach them with, and those go on in turn
+int World::SpreadLight(int channel, bool edited) {
+  for (size_t head = 0; head < lightAddQueue.size(); head++) {
+    LightNode node = lightAddQueue[head];
+    Chunk *chunk = FindLitChunk(node.x, node.y, node.z);
+    if (!chunk)
+      continue;
+    int index = LightIndex(node.x, node.y, node.z);
+    int level = Light(*chunk, channel).Get(index);
+    if (level <= 1)
+      continue; // Too dim to light anything
+    for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+      int x = node.x + LIGHT_STEP[face][0];
+      int y = node.y + LIGHT_STEP[face][1];
+      int z = node.z + LIGHT_STEP[face][2];
+      bool leaves = StepLeavesChunk(node.x, node.y, node.z, face);
+      Chunk *next = leaves ? FindLitChunk(x, y, z) : chunk;
+      if (!next)
+        continue;
+      LightSection &light = Light(*next, channel);
+      int i = leaves ? LightIndex(x, y, z) : index + LIGHT_INDEX_STEP[face];
+      // Not even through air would it beat what's there, so skip the block
+      if (LightStep(channel, face, level, 0) <= light.Get(i))
+        continue;
+      BlockType type =
+          Blocks(*next).Get(BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z));
+      int reach = LightStep(channel, face, level, BlockLightOpacity(type));
+      if (reach <= light.Get(i))
+        continue;
+      light.Set(i, reach);
+      MarkLightChanged(*next, x, y, z, edited);
+      lightAddQueue.push_back({x, y, z, reach});
+    }
+  }
+  int visited = (int)lightAddQueue.size();
+  lightAddQueue.clear();
+  FlushLightChanges(edited);
+  return visited;
+}
 
-        // RIGHT (X+) - Face Normal (1, 0, 0)
-        if (x == WORLD_WIDTH - 1 || !grid[x + 1][y][z].active ||
-            (grid[x + 1][y][z].type == BLOCK_LEAVES && type != BLOCK_LEAVES)) {
-          // Previously CW.
-          // Need (1, 0, 0).
-          // Vertices at x+1:
-          // BL(z+1, y), TL(z+1, y+1), TR(z, y+1), BR(z, y)
-          // (z+1, y) -> (z, y+1) -> (z+1, y+1)
-          // V1: (-1, 1). V2: (0, 1).
-          // | i j k |
-          // | 0 1 -1| (z,y) order? No.
-          // P0(z+1, y). P1(z, y+1). P2(z+1, y+1).
-          // P1-P0 = (0, 1, -1).
-          // P2-P0 = (0, 1, 0).
-          // | i j k |
-          // | 0 1 -1|
-          // | 0 1 0 |
-          // i (1) ... = (1, 0, 0). CORRECT.
-
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y, (float)z + 1}); // BL
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z}); // TR
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z + 1}); // TL
-
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y, (float)z + 1});            // BL
-          vertices.push_back((Vector3){(float)x + 1, (float)y, (float)z}); // BR
-          vertices.push_back(
-              (Vector3){(float)x + 1, (float)y + 1, (float)z}); // TR
-
-          for (int k = 0; k < 6; k++)
-            normals.push_back((Vector3){1, 0, 0});
-
-          float u = uSide;
-          float v = vSide;
-          float vH = 0.125f;
-          float uW = 0.125f;
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u, v});
-          texcoords.push_back((Vector2){u + uW, v});
-
-          texcoords.push_back((Vector2){u + uW, v + vH});
-          texcoords.push_back((Vector2){u, v + vH});
-          texcoords.push_back((Vector2){u, v});
+// Breadth-first from cells that went dark, with the level each had: a
+// neighbour that is dimmer (or the full sky shaft right below) got its light
+// from there and goes dark too. Brighter ones are lit from elsewhere and are
+// queued to spread back in, as are lamps that were put out.
+int World::UnspreadLight(int channel, bool edited) {
+  for (size_t head = 0; head < lightRemoveQueue.size(); head++) {
+    LightNode node = lightRemoveQueue[head];
+    Chunk *chunk = FindLitChunk(node.x, node.y, node.z);
+    int index = LightIndex(node.x, node.y, node.z);
+    for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+      int x = node.x + LIGHT_STEP[face][0];
+      int y = node.y + LIGHT_STEP[face][1];
+      int z = node.z + LIGHT_STEP[face][2];
+      bool leaves = !chunk || StepLeavesChunk(node.x, node.y, node.z, face);
+      Chunk *next = leaves ? FindLitChunk(x, y, z) : chunk;
+      if (!next)
+        continue;
+      LightSection &light = Light(*next, channel);
+      int i = leaves ? LightIndex(x, y, z) : index + LIGHT_INDEX_STEP[face];
+      int level = light.Get(i);
+      if (level == 0)
+        continue;
+      bool fromNode = level < node.level ||
+                      (channel == LIGHT_SKY && face == CHUNK_FACE_NEG_Y &&
+                       node.level == LIGHT_MAX && level == LIGHT_MAX);
+      if (!fromNode) {
+        lightAddQueue.push_back({x, y, z, level});
+        continue;
+      }
+      light.Set(i, 0);
+      MarkLightChanged(*next, x, y, z, edited);
+      lightRemoveQueue.push_back({x, y, z, level});
+      if (channel == LIGHT_BLOCK) {
+        int emission = BlockLightEmission(Blocks(*next).Get(
+            BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z)));
+        if (emission > 0) {
+          light.Set(i, emission);
+          lightAddQueue.push_back({x, y, z, emission});
         }
       }
     }
   }
+  int visited = (int)lightRemoveQueue.size();
+  lightRemoveQueue.clear();
+  FlushLightChanges(edited);
+  return visited;
+}
+
+// Faces are lit by the cell in front of them, so a relit cell changes the
+// mesh of its own chunk (`chunk`) and of any chunk across a face it lies on.
+// Those, and the column going unsaved, are noted per chunk and marked once,
+// by FlushLightChanges.
+void World::MarkLightChanged(Chunk &chunk, int x, int y, int z,
+                             bool edited) {
+  chunk.dirty = true;
+  chunk.edited = chunk.edited || edited;
+  int lx = BlockToLocal(x), ly = y % CHUNK_SIZE, lz = BlockToLocal(z);
+  int faces = (lx == 0) << CHUNK_FACE_NEG_X |
+              (lx == CHUNK_SIZE - 1) << CHUNK_FACE_POS_X |
+              (ly == 0) << CHUNK_FACE_NEG_Y |
+              (ly == CHUNK_SIZE - 1) << CHUNK_FACE_POS_Y |
+              (lz == 0) << CHUNK_FACE_NEG_Z |
+              (lz == CHUNK_SIZE - 1) << CHUNK_FACE_POS_Z;
+  if (!(chunk.lightFaces & CHUNK_EDIT_TOUCHED)) {
+    chunk.lightFaces = CHUNK_EDIT_TOUCHED;
+    litChunks.push_back(
+        {&chunk, {BlockToChunk(x), y / CHUNK_SIZE, BlockToChunk(z)}});
+  }
+  chunk.lightFaces |= faces;
+}
+
+// Remeshes the chunks across the faces MarkLightChanged noted, and has the
+// relit columns saved again: saved light is what the next load starts from
+void World::FlushLightChanges(bool edited) {
+  for (const EditedChunk &lit : litChunks) {
+    const ChunkCoord &c = lit.coord;
+    ChunkColumn *column = FindColumn(c.cx, c.cz);
+    column->unsaved = true;
+    for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+      if (!(lit.chunk->lightFaces & (1 << face)))
+        continue;
+      int cy = c.cy + LIGHT_STEP[face][1];
+      ChunkColumn *across = column;
+      if (cy == c.cy) {
+        across = FindColumn(c.cx + LIGHT_STEP[face][0],
+                            c.cz + LIGHT_STEP[face][2]);
+        if (!across || across->state != COLUMN_READY)
+          column->staleSides |= 1 << face;
+      }
+      if (!across || cy < 0 || cy >= WORLD_COLUMN_CHUNKS)
+        continue;
+      across->chunks[cy].dirty = true;
+      across->chunks[cy].edited = across->chunks[cy].edited || edited;
+    }
+    lit.chunk->lightFaces = 0;
+  }
+  litChunks.clear();
+}
+
+int World::GetSkyLight(int x, int y, int z) {
+  if (y >= WORLD_HEIGHT)
+    return LIGHT_MAX;
+  Chunk *chunk = FindLitChunk(x, y, z);
+  return chunk ? chunk->skyLight.Get(LightIndex(x, y, z)) : 0;
+}
+
+int World::GetBlockLight(int x, int y, int z) {
+  Chunk *chunk = FindLitChunk(x, y, z);
+  return chunk ? chunk->blockLight.Get(LightIndex(x, y, z)) : 0;
+}
+
+ChunkColumn *World::FindColumn(int cx, int cz) {
+  if (lastColumn && lastColumn->cx == cx && lastColumn->cz == cz)
+    return lastColumn;
+  auto it = columns.find(ColumnKey(cx, cz));
+  if (it == columns.end() || it->second->state == COLUMN_GENERATING ||
+      it->second->state == COLUMN_SAVING)
+    return nullptr; // A worker or the I/O thread owns its blocks
+  lastColumn = it->second;
+  return lastColumn;
+}
+
+Chunk *World::FindChunk(int cx, int cy, int cz) {
+  if (cy < 0 || cy >= WORLD_COLUMN_CHUNKS)
+    return nullptr;
+  ChunkColumn *column = FindColumn(cx, cz);
+  return column ? &column->chunks[cy] : nullptr;
+}
+
+bool World::IsNeighbourhoodReady(int cx, int cz) {
+  for (int dx = -1; dx <= 1; dx++) {
+    for (int dz = -1; dz <= 1; dz++) {
+      ChunkColumn *column = FindColumn(cx + dx, cz + dz);
+      if (!column || column->state != COLUMN_READY)
+        return false;
+    }
+  }
+  return true;
+}
 
-  if (vertices.empty()) {
+// A blank (all air, unmeshed) column registered at (cx, cz), not generated
+ChunkColumn *World::AcquireColumn(int cx, int cz) {
+  ChunkColumn *column;
+  if (freeColumns.empty()) {
+    column = new ChunkColumn();
+  } else {
+    column = freeColumns.back();
+    freeColumns.pop_back();
+  }
+  column->cx = cx;
+  column->cz = cz;
+  column->state = COLUMN_GENERATING;
+  column->unsaved = false;
+  column->fromDisk = false;
+  column->joinedSides = 0;
+  column->staleSides = 0;
+  for (Chunk &chunk : column->chunks) {
     chunk.active = false;
+    chunk.dirty = true;
+    chunk.edited = false;
+    chunk.meshing = false;
+    chunk.mesh = {0};
+    chunk.minY = 0;
+    chunk.maxY = 0;
+    // Open until meshed, so unmeshed chunks never hide anything
+    chunk.visibility = CHUNK_VISIBILITY_ALL;
+    chunk.editFaces = 0;
+    chunk.lightFaces = 0;
+    chunk.blocks.Fill(BLOCK_AIR);
+    chunk.encoded = nullptr;
+    chunk.skyLight.Fill(0);
+    chunk.blockLight.Fill(0);
+  }
+  columns[ColumnKey(cx, cz)] = column;
+  return column;
+}
+
+void World::EvictColumn(ChunkColumn *column) {
+  for (Chunk &chunk : column->chunks)
+    UnloadChunkMesh(chunk);
+  if (lastColumn == column)
+    lastColumn = nullptr;
+  if (!regionStore.IsWritable() || !column->unsaved) {
+    // Edits dropped with a read-only save: it comes back without them, so
+    // the light across from it may be theirs
+    for (int side : COLUMN_SIDES) {
+      ChunkColumn *other = FindColumn(column->cx + LIGHT_STEP[side][0],
+                                      column->cz + LIGHT_STEP[side][2]);
+      if (column->unsaved && other)
+        other->staleSides |= 1 << (side ^ 1);
+    }
+    ReleaseColumn(column); // Nothing to keep, or it regenerates the same
     return;
   }
 
-  // Convert vector to Mesh
-  Mesh mesh = {0};
-  mesh.vertexCount = vertices.size();
-  mesh.triangleCount = vertices.size() / 3;
+  // Handed to the I/O thread as is, no copy. It stays in the map, hidden,
+  // until staged in the store, so coming back to it can't load the old
+  // record. It reaches the disk with the next autosave.
+  column->joinedSides = ReadySides(*column);
+  column->state = COLUMN_SAVING;
+  ioPool.Submit([this, column]() {
+    EncodeColumn(*column, saveRecord);
+    regionStore.Write(column->cx, column->cz, saveRecord.data(),
+                      saveRecord.size());
+    std::lock_guard<std::mutex> lock(saveMutex);
+    savedColumns.push_back(column);
+  });
+}
+
+void World::ReleaseColumn(ChunkColumn *column) {
+  for (Chunk &chunk : column->chunks) {
+    chunk.blocks.Fill(BLOCK_AIR); // Frees the cell arrays
+    chunk.encoded = nullptr;
+    chunk.skyLight.Fill(0);
+    chunk.blockLight.Fill(0);
+  }
+  columns.erase(ColumnKey(column->cx, column->cz));
+  freeColumns.push_back(column);
+}
+
+void World::CollectSavedColumns() {
+  std::lock_guard<std::mutex> lock(saveMutex);
+  for (ChunkColumn *column : savedColumns)
+    ReleaseColumn(column);
+  savedColumns.clear();
+}
 
-  // Allocate memory
-  mesh.vertices = (float *)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
-  mesh.texcoords = (float *)MemAlloc(mesh.vertexCount * 2 * sizeof(float));
-  mesh.normals = (float *)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
+bool World::OpenSave(const char *directory, bool readOnly) {
+  if (!regionStore.Open(directory, seed, readOnly))
+    return false;
+  if (!readOnly)
+    ioPool.Start(1);
+  return true;
+}
 
-  // Fill data
-  for (size_t i = 0; i < vertices.size(); i++) {
-    mesh.vertices[i * 3] = vertices[i].x;
-    mesh.vertices[i * 3 + 1] = vertices[i].y;
-    mesh.vertices[i * 3 + 2] = vertices[i].z;
+void World::Autosave() {
+  if (!regionStore.IsWritable() || autosaving)
+    return;
+  ProfileScope scope(PROFILE_SAVE_SNAPSHOT);
+  int64_t start = Profiler::NowNs();
+  lastAutosaveTime = headless ? 0.0 : GetTime();
+
+  // Columns being generated aren't in the save yet, and SAVING ones are
+  // already queued on the I/O thread
+  int count = 0;
+  for (auto &entry : columns) {
+    ChunkColumn *column = entry.second;
+    if (!column->unsaved || column->state == COLUMN_GENERATING ||
+        column->state == COLUMN_SAVING)
+      continue;
+    if (count == (int)snapshots.size())
+      snapshots.push_back(new ChunkColumn());
+    ChunkColumn *copy = snapshots[count++];
+    copy->cx = column->cx;
+    copy->cz = column->cz;
+    copy->landState = column->landState;
+    copy->joinedSides = ReadySides(*column);
+    copy->staleSides = column->staleSides;
+    copy->trees = column->trees;
+    for (int i = 0; i < WORLD_COLUMN_CHUNKS; i++) {
+      copy->chunks[i].blocks.CopyFrom(column->chunks[i].blocks);
+      copy->chunks[i].skyLight.CopyFrom(column->chunks[i].skyLight);
+      copy->chunks[i].blockLight.CopyFrom(column->chunks[i].blockLight);
+    }
+    column->unsaved = false; // Edits from here on go in the next save
+  }
 
-    mesh.normals[i * 3] = normals[i].x;
-    mesh.normals[i * 3 + 1] = normals[i].y;
-    mesh.normals[i * 3 + 2] = normals[i].z;
+  autosaving = true;
+  double snapshotMs = (Profiler::NowNs() - start) / 1000000.0;
+  ioPool.Submit(
+      [this, count, snapshotMs]() { WriteAutosave(count, snapshotMs); });
+}
 
-    mesh.texcoords[i * 2] = texcoords[i].x;
-    mesh.texcoords[i * 2 + 1] = texcoords[i].y;
+void World::WriteAutosave(int count, double snapshotMs) {
+  ProfileScope scope(PROFILE_SAVE_WRITE);
+  int64_t start = Profiler::NowNs();
+  size_t bytesBefore = regionStore.GetBytesWritten();
+  for (int i = 0; i < count; i++) {
+    ChunkColumn *copy = snapshots[i];
+    EncodeColumn(*copy, saveRecord);
+    regionStore.Write(copy->cx, copy->cz, saveRecord.data(),
+                      saveRecord.size());
+    for (Chunk &chunk : copy->chunks) {
+      chunk.blocks.Fill(BLOCK_AIR); // Memory only held while saving
+      chunk.skyLight.Fill(0);
+      chunk.blockLight.Fill(0);
+    }
   }
+  bool ok = regionStore.Commit();
+
+  SaveStats stats;
+  stats.columns = count;
+  stats.bytes = regionStore.GetBytesWritten() - bytesBefore;
+  stats.snapshotMs = snapshotMs;
+  stats.writeMs = (Profiler::NowNs() - start) / 1000000.0;
+  if (!ok)
+    TraceLog(LOG_WARNING, "WORLD: autosave failed, retrying next time");
+  else if (stats.bytes > 0)
+    TraceLog(LOG_INFO,
+             "WORLD: autosaved %d columns, %zu KB in %.1f ms (%.2f ms on the "
+             "main thread)",
+             stats.columns, stats.bytes / 1024, stats.writeMs,
+             stats.snapshotMs);
+  std::lock_guard<std::mutex> lock(saveMutex);
+  lastSave = stats;
+  autosaving = false;
+}
 
-  UploadMesh(&mesh, false);
+void World::WaitForAutosave() {
+  if (regionStore.IsWritable())
+    ioPool.Wait();
+}
 
-  chunk.model = LoadModelFromMesh(mesh);
-  chunk.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = atlasTexture;
-  chunk.active = true;
+SaveStats World::GetLastSaveStats() {
+  std::lock_guard<std::mutex> lock(saveMutex);
+  return lastSave;
 }
 
-void World::Draw(Vector3 playerPos) {
-  int renderDist = 4; // 8 chunks radius = 8*16 = 128 blocks
-  // Increase render dist for 1024 map to see more?
-  // Let's try 8 chunks.
-
-  int pcx = (int)playerPos.x / CHUNK_SIZE;
-  int pcy = (int)playerPos.y / CHUNK_SIZE;
-  int pcz = (int)playerPos.z / CHUNK_SIZE;
-
-  int minCX = pcx - renderDist;
-  int maxCX = pcx + renderDist;
-  int minCY = pcy - renderDist;
-  int maxCY = pcy + renderDist;
-  int minCZ = pcz - renderDist;
-  int maxCZ = pcz + renderDist;
-
-  // Clamp
-  if (minCX < 0)
-    minCX = 0;
-  if (maxCX >= WORLD_WIDTH / CHUNK_SIZE)
-    maxCX = WORLD_WIDTH / CHUNK_SIZE;
-  if (minCY < 0)
-    minCY = 0;
-  if (maxCY >= WORLD_HEIGHT / CHUNK_SIZE)
-    maxCY = WORLD_HEIGHT / CHUNK_SIZE;
-  if (minCZ < 0)
-    minCZ = 0;
-  if (maxCZ >= WORLD_DEPTH / CHUNK_SIZE)
-    maxCZ = WORLD_DEPTH / CHUNK_SIZE;
-
-  for (int cx = minCX; cx < maxCX; cx++) {
-    for (int cy = minCY; cy < maxCY;
-         cy++) { // Draw all height? Or cull? Cull height too.
-      for (int cz = minCZ; cz < maxCZ; cz++) {
-        if (chunks[cx][cy][cz].active) {
-          DrawModel(chunks[cx][cy][cz].model, (Vector3){0, 0, 0}, 1.0f, WHITE);
+// Column record: flags (1 byte, COLUMN_RECORD_*), tree count (2 bytes),
+// 4 bytes per tree, then each section's ChunkSection::Encode stream from the
+// bottom up. A READY column's light follows as it is, each section's sky
+// then block LightSection::Encode stream, then joinedSides and staleSides
+// (a byte each) for JoinColumnLight to square it with the neighbours.
+void World::EncodeColumn(const ChunkColumn &column,
+                         std::vector<uint8_t> &record) {
+  bool ready = column.landState == COLUMN_READY; // state may be SAVING
+  record.clear();
+  record.push_back(ready ? COLUMN_RECORD_READY | COLUMN_RECORD_LIGHT : 0);
+  record.push_back((uint8_t)column.trees.size());
+  record.push_back((uint8_t)(column.trees.size() >> 8));
+  for (const TreeSite &tree : column.trees) {
+    record.push_back(tree.lx);
+    record.push_back(tree.y);
+    record.push_back(tree.lz);
+    record.push_back(tree.height);
+  }
+  for (const Chunk &chunk : column.chunks)
+    chunk.blocks.Encode(record);
+  if (!ready)
+    return;
+  for (const Chunk &chunk : column.chunks) {
+    chunk.skyLight.Encode(record);
+    chunk.blockLight.Encode(record);
+  }
+  record.push_back(column.joinedSides);
+  record.push_back(column.staleSides);
+}
+
+uint8_t World::ReadySides(const ChunkColumn &column) {
+  uint8_t sides = 0;
+  for (int side : COLUMN_SIDES) {
+    ChunkColumn *other = FindColumn(column.cx + LIGHT_STEP[side][0],
+                                    column.cz + LIGHT_STEP[side][2]);
+    if (other && other->state == COLUMN_READY)
+      sides |= 1 << side;
+  }
+  return sides;
+}
+
+// Lazy leaves sections with more than one run encoded, pointing into data,
+// for Blocks to decode on first access. The stream is still checked here.
+bool World::DecodeColumn(ChunkColumn &column, const uint8_t *data,
+                         size_t size, bool lazy) {
+  if (size < 3)
+    return false;
+  column.landState =
+      data[0] & COLUMN_RECORD_READY ? COLUMN_READY : COLUMN_TERRAIN;
+  size_t treeCount = data[1] | data[2] << 8;
+  size_t pos = 3;
+  if (size < pos + treeCount * 4)
+    return false;
+  column.trees.clear();
+  for (size_t i = 0; i < treeCount; i++, pos += 4)
+    column.trees.push_back(
+        {data[pos], data[pos + 1], data[pos + 2], data[pos + 3]});
+  for (Chunk &chunk : column.chunks) {
+    int runs;
+    size_t used = ChunkSection::EncodedSize(data + pos, size - pos, runs);
+    if (used == 0)
+      return false;
+    if (lazy && runs > 1) {
+      chunk.encoded = data + pos;
+      chunk.encodedSize = (uint32_t)used;
+    } else {
+      chunk.blocks.Decode(data + pos, used);
+    }
+    pos += used;
+  }
+  column.joinedSides = 0;
+  column.staleSides = 0;
+  if (data[0] & COLUMN_RECORD_LIGHT) {
+    for (Chunk &chunk : column.chunks) {
+      for (LightSection *light : {&chunk.skyLight, &chunk.blockLight}) {
+        size_t used = light->Decode(data + pos, size - pos);
+        if (used == 0)
+          return false;
+        pos += used;
+      }
+    }
+    if (size < pos + 2)
+      return false;
+    column.joinedSides = data[pos++];
+    column.staleSides = data[pos++];
+  }
+  return pos == size;
+}
+
+void World::DecodeChunk(Chunk &chunk) {
+  chunk.blocks.Decode(chunk.encoded, chunk.encodedSize);
+  chunk.encoded = nullptr;
+}
+
+// Job body: the saved column if there is one, else fresh terrain
+void World::LoadOrGenerateColumn(ChunkColumn &column) {
+  thread_local std::vector<uint8_t> record;
+  column.fromDisk = false;
+  column.landState = COLUMN_TERRAIN;
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  bool mapped = regionStore.IsMapped();
+  if (mapped ? regionStore.ReadMapped(column.cx, column.cz, data, size)
+             : regionStore.Read(column.cx, column.cz, record)) {
+    if (!mapped) {
+      data = record.data();
+      size = record.size();
+    }
+    column.fromDisk = DecodeColumn(column, data, size, mapped);
+    if (column.fromDisk) {
+      if (column.landState == COLUMN_READY &&
+          !(data[0] & COLUMN_RECORD_LIGHT))
+        LightColumn(column); // Saved before light was
+      return;
+    }
+    TraceLog(LOG_WARNING, "WORLD: bad record for column %d, %d, regenerating",
+             column.cx, column.cz);
+    column.joinedSides = 0;
+    column.staleSides = 0;
+    for (Chunk &chunk : column.chunks) {
+      chunk.blocks.Fill(BLOCK_AIR);
+      chunk.encoded = nullptr;
+    }
+  }
+  GenerateColumn(column);
+}
+
+void World::StreamColumns(Vector3 playerPos) {
+  int pcx = (int)floorf(playerPos.x / CHUNK_SIZE);
+  int pcz = (int)floorf(playerPos.z / CHUNK_SIZE);
+
+  // Evict out past the margin, so walking back and forth across one border
+  // doesn't regenerate the same columns. Columns with a terrain or mesh job
+  // in flight wait for it to land. Nothing is evicted while an autosave is
+  // writing: a column it copied could be dropped and loaded back from the
+  // old file before the copy is staged in the store.
+  CollectSavedColumns();
+  int unloadRadius = renderDistance + COLUMN_UNLOAD_MARGIN;
+  evictQueue.clear();
+  if (!autosaving) {
+    for (auto &entry : columns) {
+      ChunkColumn *column = entry.second;
+      if (abs(column->cx - pcx) <= unloadRadius &&
+          abs(column->cz - pcz) <= unloadRadius)
+        continue;
+      bool busy = column->state == COLUMN_GENERATING ||
+                  column->state == COLUMN_SAVING;
+      for (const Chunk &chunk : column->chunks)
+        busy = busy || chunk.meshing;
+      if (!busy)
+        evictQueue.push_back(column);
+    }
+  }
+  for (ChunkColumn *column : evictQueue)
+    EvictColumn(column);
+
+  int landed = CollectGeneratedColumns(false);
+
+  // Missing columns in range, ring by ring from the player's
+  int loadRadius = renderDistance + 2;
+  generateQueue.clear();
+  for (int cx = pcx - loadRadius; cx <= pcx + loadRadius; cx++) {
+    for (int cz = pcz - loadRadius; cz <= pcz + loadRadius; cz++) {
+      if (columns.find(ColumnKey(cx, cz)) == columns.end()) {
+        int dx = cx - pcx, dz = cz - pcz;
+        generateQueue.push_back({dx * dx + dz * dz, cx, cz});
+      }
+    }
+  }
+  std::sort(generateQueue.begin(), generateQueue.end(),
+            [](const ColumnCandidate &a, const ColumnCandidate &b) {
+              return a.distance < b.distance;
+            });
+
+  for (const ColumnCandidate &c : generateQueue) {
+    // The 5x5 around the player (distance <= 8) is generated right here, so
+    // the 3x3 the player stands in gets its trees this frame
+    if (!headless && c.distance <= 8) {
+      ChunkColumn *column = AcquireColumn(c.cx, c.cz);
+      LoadOrGenerateColumn(*column);
+      LandColumn(column);
+      landed++;
+      continue;
+    }
+    if (!headless && generateJobsInFlight >= MAX_GENERATE_JOBS_IN_FLIGHT)
+      break;
+    SubmitColumn(AcquireColumn(c.cx, c.cz));
+  }
+  if (headless)
+    landed += CollectGeneratedColumns(true);
+
+  // Only new terrain can complete a neighbourhood
+  if (landed > 0)
+    DecorateColumns();
+}
+
+// Generates a column's terrain on the workers. It stays hidden from
+// FindColumn until CollectGeneratedColumns picks it up.
+void World::SubmitColumn(ChunkColumn *column) {
+  generateJobsInFlight++;
+  workerPool.Submit([this, column]() {
+    LoadOrGenerateColumn(*column);
+    {
+      std::lock_guard<std::mutex> lock(generateMutex);
+      generateResults.push_back(column);
+    }
+    generateDone.notify_one();
+  });
+}
+
+// Hands finished terrain to the main thread and returns how many columns
+// landed. With wait, first blocks until every job in flight is done.
+int World::CollectGeneratedColumns(bool wait) {
+  std::unique_lock<std::mutex> lock(generateMutex);
+  if (wait)
+    generateDone.wait(lock, [this] {
+      return (int)generateResults.size() == generateJobsInFlight;
+    });
+  for (ChunkColumn *column : generateResults)
+    LandColumn(column);
+  int landed = (int)generateResults.size();
+  generateJobsInFlight -= landed;
+  generateResults.clear();
+  return landed;
+}
+
+// Loaded columns come back as they were saved. Generated ones still need
+// their trees and aren't in the save yet.
+void World::LandColumn(ChunkColumn *column) {
+  column->state = column->landState;
+  column->unsaved = !column->fromDisk;
+  if (column->state == COLUMN_READY)
+    joinQueue.push_back(column);
+  if (column->fromDisk)
+    columnsRead++;
+  else
+    columnsGenerated++;
+}
+
+// Places trees in every column whose 8 neighbours have terrain
+void World::DecorateColumns() {
+  decorateQueue.clear();
+  for (auto &entry : columns) {
+    ChunkColumn *column = entry.second;
+    if (column->state != COLUMN_TERRAIN)
+      continue;
+    bool surrounded = true;
+    for (int dx = -1; dx <= 1 && surrounded; dx++)
+      for (int dz = -1; dz <= 1 && surrounded; dz++)
+        surrounded = FindColumn(column->cx + dx, column->cz + dz) != nullptr;
+    if (surrounded)
+      decorateQueue.push_back(column);
+  }
+
+  if (!headless) {
+    // A frame only finishes a ring of columns, cheap enough to do here
+    for (ChunkColumn *column : decorateQueue)
+      DecorateColumn(*column);
+  } else {
+    // Headless lands the whole area at once, so spread it over the workers.
+    // Each column only writes its own blocks and nothing is evicted
+    // meanwhile.
+    std::unique_lock<std::mutex> lock(generateMutex);
+    decorateJobsLeft = (int)decorateQueue.size();
+    for (ChunkColumn *column : decorateQueue) {
+      workerPool.Submit([this, column]() {
+        DecorateColumn(*column);
+        std::lock_guard<std::mutex> lock(generateMutex);
+        if (--decorateJobsLeft == 0)
+          generateDone.notify_one();
+      });
+    }
+    generateDone.wait(lock, [this] { return decorateJobsLeft == 0; });
+  }
+
+  // Every column that became READY, loaded or decorated, shares its light
+  // with the READY ones around
+  joinQueue.insert(joinQueue.end(), decorateQueue.begin(),
+                   decorateQueue.end());
+  JoinQueuedLight();
+}
+
+void World::Update(Vector3 playerPos) {
+  ProfileScope scope(PROFILE_WORLD_UPDATE);
+  StreamColumns(playerPos);
+  if (!headless && GetTime() - lastAutosaveTime >= AUTOSAVE_INTERVAL)
+    Autosave();
+  // At most one water tick a frame: a backlog waits in the active set
+  // instead of ticks piling up
+  if (!headless && GetTime() - lastWaterTime >= 1.0 / WATER_TICK_RATE) {
+    lastWaterTime = GetTime();
+    TickWater();
+  }
+
+  // Dirty chunks in range, keyed by squared distance from the player to the
+  // chunk centre. Off-screen chunks count as further away, and edited chunks
+  // go before everything else regardless of distance. A column is only
+  // meshed once it and its neighbours have their trees, so its blocks and
+  // border faces are final.
+  ChunkWindow w = GetChunkWindow(playerPos);
+  rebuildQueue.clear();
+  for (int cx = w.minCX; cx < w.maxCX; cx++) {
+    for (int cz = w.minCZ; cz < w.maxCZ; cz++) {
+      if (!IsNeighbourhoodReady(cx, cz))
+        continue;
+      ChunkColumn *column = FindColumn(cx, cz);
+      for (int cy = w.minCY; cy < w.maxCY; cy++) {
+        const Chunk &chunk = column->chunks[cy];
+        if (!chunk.dirty || chunk.meshing)
+          continue;
+
+        float dx = cx * CHUNK_SIZE + CHUNK_SIZE / 2.0f - playerPos.x;
+        float dy = cy * CHUNK_SIZE + CHUNK_SIZE / 2.0f - playerPos.y;
+        float dz = cz * CHUNK_SIZE + CHUNK_SIZE / 2.0f - playerPos.z;
+        float priority = dx * dx + dy * dy + dz * dz;
+        if (hasLastFrustum) {
+          Vector3 min = {(float)(cx * CHUNK_SIZE), (float)(cy * CHUNK_SIZE),
+                         (float)(cz * CHUNK_SIZE)};
+          Vector3 max = {(float)((cx + 1) * CHUNK_SIZE),
+                         (float)((cy + 1) * CHUNK_SIZE),
+                         (float)((cz + 1) * CHUNK_SIZE)};
+          if (!lastFrustum.IntersectsBox(min, max))
+            priority *= MESH_OFF_SCREEN_BIAS * MESH_OFF_SCREEN_BIAS;
+        }
+        if (chunk.edited)
+          priority = -1.0f / (1.0f + priority); // Negative, nearest lowest
+        rebuildQueue.push_back({priority, {cx, cy, cz}});
+      }
+    }
+  }
+  std::sort(rebuildQueue.begin(), rebuildQueue.end(),
+            [](const RebuildCandidate &a, const RebuildCandidate &b) {
+              return a.priority < b.priority;
+            });
+
+  // Hand them to the mesh workers in that order until the frame's budget is
+  // spent. The in-flight cap bounds snapshot memory; it refills as soon as
+  // results are uploaded. Headless meshing is synchronous and has no frame
+  // to protect, so it takes everything.
+  int64_t deadline =
+      Profiler::NowNs() + (int64_t)(MESH_SCHEDULE_BUDGET * 1000000000.0);
+  for (const RebuildCandidate &c : rebuildQueue) {
+    if (meshJobsInFlight >= MAX_MESH_JOBS_IN_FLIGHT)
+      break;
+    if (!headless && Profiler::NowNs() > deadline)
+      break;
+    RebuildChunk(c.coord.cx, c.coord.cy, c.coord.cz);
+  }
+
+  if (!headless)
+    UploadFinishedMeshes();
+}
+
+// Render distance around the player's chunk, clamped to the world height.
+// Empty when the player is far above or below it.
+ChunkWindow World::GetChunkWindow(Vector3 playerPos) {
+  int pcx = (int)floorf(playerPos.x / CHUNK_SIZE);
+  int pcy = (int)floorf(playerPos.y / CHUNK_SIZE);
+  int pcz = (int)floorf(playerPos.z / CHUNK_SIZE);
+
+  ChunkWindow w;
+  w.minCX = pcx - renderDistance;
+  w.maxCX = pcx + renderDistance + 1;
+  w.minCY = std::max(pcy - renderDistance, 0);
+  w.maxCY = std::min(pcy + renderDistance + 1, WORLD_COLUMN_CHUNKS);
+  w.minCZ = pcz - renderDistance;
+  w.maxCZ = pcz + renderDistance + 1;
+  return w;
+}
+
+void World::SetRenderDistance(int chunks) {
+  renderDistance =
+      std::max(MIN_RENDER_DISTANCE, std::min(chunks, MAX_RENDER_DISTANCE));
+}
+
+// Snapshots a chunk and queues it for meshing on the worker pool
+void World::RebuildChunk(int cx, int cy, int cz) {
+  Chunk &chunk = *FindChunk(cx, cy, cz);
+  chunk.dirty = false;
+  chunk.edited = false;
+
+  // All-air chunks never produce faces, skip the round trip
+  const ChunkSection &blocks = Blocks(chunk);
+  if (blocks.IsUniform() && blocks.GetUniformType() == BLOCK_AIR) {
+    UnloadChunkMesh(chunk);
+    chunk.visibility = CHUNK_VISIBILITY_ALL;
+    return;
+  }
+
+  MeshJob *job = AcquireMeshJob();
+  {
+    ProfileScope scope(PROFILE_MESH_SNAPSHOT);
+    SnapshotChunk(cx, cy, cz, job->snapshot);
+  }
+  job->mode = meshingMode;
+
+  if (headless) {
+    // No workers and no GPU: mesh right here and just record the result
+    BuildChunkMesh(job->snapshot, job->mode, job->mesh);
+    UploadChunkMesh(job->mesh);
+    freeMeshJobs.push_back(job);
+    return;
+  }
+
+  chunk.meshing = true;
+  meshJobsInFlight++;
+  workerPool.Submit([this, job]() {
+    BuildChunkMesh(job->snapshot, job->mode, job->mesh);
+
+    std::lock_guard<std::mutex> lock(meshResultMutex);
+    meshResults.push_back(job);
+  });
+}
+
+// Jobs come from a free list and go back after upload. New ones are only
+// created until the pool covers MAX_MESH_JOBS_IN_FLIGHT, so after warm-up
+// meshing makes no heap allocations (meshAllocations stops growing).
+World::MeshJob *World::AcquireMeshJob() {
+  if (freeMeshJobs.empty()) {
+    meshJobStorage.push_back(new MeshJob());
+    meshAllocations++;
+    return meshJobStorage.back();
+  }
+  MeshJob *job = freeMeshJobs.back();
+  freeMeshJobs.pop_back();
+  return job;
+}
+
+void World::SnapshotChunk(int cx, int cy, int cz, ChunkSnapshot &snapshot) {
+  snapshot.cx = cx;
+  snapshot.cy = cy;
+  snapshot.cz = cz;
+
+  // Walk the 3x3x3 block of sections around the chunk and copy the part of
+  // each that falls inside the padded snapshot. Missing sections are air,
+  // open sky above the world and dark below it.
+  for (int ox = -1; ox <= 1; ox++) {
+    for (int oy = -1; oy <= 1; oy++) {
+      for (int oz = -1; oz <= 1; oz++) {
+        int nx = cx + ox;
+        int ny = cy + oy;
+        int nz = cz + oz;
+        Chunk *neighbour = FindChunk(nx, ny, nz);
+        const ChunkSection *section = neighbour ? &Blocks(*neighbour) : nullptr;
+        bool uniformLight = !neighbour || (neighbour->skyLight.IsUniform() &&
+                                           neighbour->blockLight.IsUniform());
+        uint8_t light =
+            neighbour ? PackLight(neighbour->skyLight.GetUniformLevel(),
+                                  neighbour->blockLight.GetUniformLevel())
+                      : PackLight(ny >= WORLD_COLUMN_CHUNKS ? LIGHT_MAX : 0, 0);
+
+        // Local range inside the neighbour: the far edge, all, or near edge
+        int x0 = ox < 0 ? CHUNK_SIZE - 1 : 0, x1 = ox > 0 ? 0 : CHUNK_SIZE - 1;
+        int y0 = oy < 0 ? CHUNK_SIZE - 1 : 0, y1 = oy > 0 ? 0 : CHUNK_SIZE - 1;
+        int z0 = oz < 0 ? CHUNK_SIZE - 1 : 0, z1 = oz > 0 ? 0 : CHUNK_SIZE - 1;
+
+        for (int y = y0; y <= y1; y++) {
+          for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+              BlockType type = section ? section->Get(x, y, z) : BLOCK_AIR;
+              int i = ChunkSnapshot::Index(x + ox * CHUNK_SIZE,
+                                           y + oy * CHUNK_SIZE,
+                                           z + oz * CHUNK_SIZE);
+              snapshot.cells[i] = (uint8_t)type;
+              int cell = ChunkSection::Index(x, y, z);
+              snapshot.light[i] =
+                  uniformLight ? light
+                               : PackLight(neighbour->skyLight.Get(cell),
+                                           neighbour->blockLight.Get(cell));
+            }
+          }
         }
       }
     }
   }
 }
 
-Block World::GetBlock(int x, int y, int z) {
-  if (x >= 0 && x < WORLD_WIDTH && y >= 0 && y < WORLD_HEIGHT && z >= 0 &&
-      z < WORLD_DEPTH) {
-    return grid[x][y][z];
-  }
-  return {false, BLOCK_AIR};
-}
-
-World::WorldRayHit World::GetRayCollision(Ray ray) {
-  WorldRayHit closestHit = {false};
-  closestHit.distance = 999999.0f;
-
-  int cx = (int)ray.position.x;
-  int cy = (int)ray.position.y;
-  int cz = (int)ray.position.z;
-  int radius = 8;
-
-  int minX = cx - radius;
-  if (minX < 0)
-    minX = 0;
-  int maxX = cx + radius;
-  if (maxX >= WORLD_WIDTH)
-    maxX = WORLD_WIDTH - 1;
-  int minY = cy - radius;
-  if (minY < 0)
-    minY = 0;
-  int maxY = cy + radius;
-  if (maxY >= WORLD_HEIGHT)
-    maxY = WORLD_HEIGHT - 1;
-  int minZ = cz - radius;
-  if (minZ < 0)
-    minZ = 0;
-  int maxZ = cz + radius;
-  if (maxZ >= WORLD_DEPTH)
-    maxZ = WORLD_DEPTH - 1;
-
-  for (int x = minX; x <= maxX; x++) {
-    for (int y = minY; y <= maxY; y++) {
-      for (int z = minZ; z <= maxZ; z++) {
-        if (!grid[x][y][z].active)
+void World::BuildChunkMeshNow(int cx, int cy, int cz,
+                              ChunkSnapshot &snapshot, ChunkMeshData &out) {
+  SnapshotChunk(cx, cy, cz, snapshot);
+  BuildChunkMesh(snapshot, meshingMode, out);
+}
+
+// Drains finished meshes, oldest first, until this frame's upload budget is
+// spent. The uploaded ones are dropped from the front once at the end: at
+// most MAX_MESH_JOBS_IN_FLIGHT pointers to move, and no reallocation.
+void World::UploadFinishedMeshes() {
+  double start = GetTime();
+  size_t next = 0;
+  while (GetTime() - start < MESH_UPLOAD_BUDGET) {
+    MeshJob *job = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(meshResultMutex);
+      if (next == meshResults.size())
+        break;
+      job = meshResults[next++];
+    }
+
+    const ChunkMeshData &data = job->mesh;
+    UploadChunkMesh(data);
+    FindChunk(data.cx, data.cy, data.cz)->meshing = false;
+    meshJobsInFlight--;
+    freeMeshJobs.push_back(job);
+  }
+  std::lock_guard<std::mutex> lock(meshResultMutex);
+  meshResults.erase(meshResults.begin(), meshResults.begin() + next);
+}
+
+// Replaces a chunk's mesh with freshly built geometry (main thread only)
+void World::UploadChunkMesh(const ChunkMeshData &data) {
+  ProfileScope scope(PROFILE_MESH_UPLOAD);
+  // Columns aren't evicted while one of their chunks is meshing
+  Chunk &chunk = *FindChunk(data.cx, data.cy, data.cz);
+  UnloadChunkMesh(chunk);
+  chunk.visibility = data.visibility; // Buried chunks with no faces need it
+
+  if (data.vertexCount == 0)
+    return;
+
+  chunk.mesh.indexCount = data.GetQuadCount() * 6;
+  chunk.minY = (uint8_t)data.minY;
+  chunk.maxY = (uint8_t)data.maxY;
+  chunk.active = true;
+  if (headless)
+    return; // Bounds and counts only, for culling without a GPU
+
+  chunk.mesh.vaoId = rlLoadVertexArray();
+  rlEnableVertexArray(chunk.mesh.vaoId);
+  chunk.mesh.vboId = rlLoadVertexBuffer(
+      data.vertices, data.vertexCount * (int)sizeof(uint32_t), false);
+  rlSetVertexAttribute(0, 4, RL_UNSIGNED_BYTE, false, 0, 0);
+  rlEnableVertexAttribute(0);
+  rlEnableVertexBufferElement(quadIndexBuffer); // Recorded in the VAO
+  rlDisableVertexArray();
+}
+
+void World::UnloadChunkMesh(Chunk &chunk) {
+  if (!chunk.active)
+    return;
+  if (!headless) {
+    rlUnloadVertexArray(chunk.mesh.vaoId);
+    rlUnloadVertexBuffer(chunk.mesh.vboId);
+  }
+  chunk.mesh = {0};
+  chunk.active = false;
+}
+
+void World::SetMeshingMode(MeshingMode mode) {
+  if (mode == meshingMode)
+    return;
+  meshingMode = mode;
+  for (auto &entry : columns)
+    for (Chunk &chunk : entry.second->chunks)
+      chunk.dirty = true;
+}
+
+void World::CollectVisibleChunks(Vector3 playerPos, const Frustum &frustum,
+                                 std::vector<ChunkCoord> &out) {
+  out.clear();
+  lastFrustum = frustum;
+  hasLastFrustum = true;
+
+  ChunkWindow w = GetChunkWindow(playerPos);
+  candidateChunks = 0;
+  if (w.IsEmpty())
+    return; // Player outside the world
+
+  // Frustum culling alone keeps every chunk in range
+  visited.assign(w.GetVolume(), occlusionCulling ? 0 : 1);
+  if (occlusionCulling)
+    WalkVisibleChunks(frustum, w);
+
+  for (int cx = w.minCX; cx < w.maxCX; cx++) {
+    for (int cz = w.minCZ; cz < w.maxCZ; cz++) {
+      ChunkColumn *column = FindColumn(cx, cz);
+      if (!column)
+        continue;
+      for (int cy = w.minCY; cy < w.maxCY; cy++) {
+        const Chunk &chunk = column->chunks[cy];
+        if (!chunk.active)
+          continue;
+        candidateChunks++;
+        if (!visited[w.Index(cx, cy, cz)])
           continue;
 
-        BoundingBox box = {
-            (Vector3){(float)x - 0.5f, (float)y - 0.5f, (float)z - 0.5f},
-            (Vector3){(float)x + 0.5f, (float)y + 0.5f, (float)z + 0.5f}};
-
-        RayCollision collision = GetRayCollisionBox(ray, box);
-        if (collision.hit && collision.distance < closestHit.distance) {
-          closestHit.hit = true;
-          closestHit.distance = collision.distance;
-          closestHit.x = x;
-          closestHit.y = y;
-          closestHit.z = z;
-          closestHit.normal = collision.normal;
+        // Box around the mesh only: empty space above and below the
+        // geometry (open sky, the flat world floor) never counts
+        Vector3 min = {(float)(cx * CHUNK_SIZE),
+                       (float)(cy * CHUNK_SIZE + chunk.minY),
+                       (float)(cz * CHUNK_SIZE)};
+        Vector3 max = {(float)((cx + 1) * CHUNK_SIZE),
+                       (float)(cy * CHUNK_SIZE + chunk.maxY),
+                       (float)((cz + 1) * CHUNK_SIZE)};
+        if (frustum.IntersectsBox(min, max))
+          out.push_back({cx, cy, cz});
+      }
+    }
+  }
+}
+
+// Breadth-first walk from the eye's chunk that marks, in visited, every chunk
+// a line of sight could reach. A step leaves a chunk through a face only if
+// open cells join it to the face the walk came in by, never heads back
+// against a direction already taken (so the walk only moves away from the
+// eye), and lands in a chunk that is in range and inside the frustum. If the
+// eye is outside the window (e.g. above the world) nothing can be culled
+// this way and every chunk is marked.
+void World::WalkVisibleChunks(const Frustum &frustum,
+                              const ChunkWindow &window) {
+  static const int STEP[CHUNK_FACE_COUNT][3] = {
+      {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+  int ecx = (int)floorf(frustum.eye.x / CHUNK_SIZE);
+  int ecy = (int)floorf(frustum.eye.y / CHUNK_SIZE);
+  int ecz = (int)floorf(frustum.eye.z / CHUNK_SIZE);
+  if (!window.Contains(ecx, ecy, ecz)) {
+    visited.assign(visited.size(), 1);
+    return;
+  }
+
+  visitQueue.clear();
+  visitQueue.push_back({{ecx, ecy, ecz}, -1, 0});
+  visited[window.Index(ecx, ecy, ecz)] = 1;
+
+  for (size_t head = 0; head < visitQueue.size(); head++) {
+    ChunkVisit v = visitQueue[head];
+    // Columns not generated yet are open space as far as the walk knows
+    const Chunk *chunk = FindChunk(v.coord.cx, v.coord.cy, v.coord.cz);
+    uint16_t links = chunk ? chunk->visibility : CHUNK_VISIBILITY_ALL;
+
+    for (int face = 0; face < CHUNK_FACE_COUNT; face++) {
+      if (v.steps & (1 << (face ^ 1)))
+        continue; // Opposite of a direction already taken
+      if (v.entryFace >= 0 && !(links & ChunkFacePairBit(v.entryFace, face)))
+        continue;
+
+      int nx = v.coord.cx + STEP[face][0];
+      int ny = v.coord.cy + STEP[face][1];
+      int nz = v.coord.cz + STEP[face][2];
+      if (!window.Contains(nx, ny, nz))
+        continue;
+      uint8_t &seen = visited[window.Index(nx, ny, nz)];
+      if (seen)
+        continue;
+
+      Vector3 min = {(float)(nx * CHUNK_SIZE), (float)(ny * CHUNK_SIZE),
+                     (float)(nz * CHUNK_SIZE)};
+      Vector3 max = {(float)((nx + 1) * CHUNK_SIZE),
+                     (float)((ny + 1) * CHUNK_SIZE),
+                     (float)((nz + 1) * CHUNK_SIZE)};
+      if (!frustum.IntersectsBox(min, max))
+        continue;
+
+      seen = 1;
+      // Entered through the face opposite to the step
+      visitQueue.push_back({{nx, ny, nz},
+                            (int8_t)(face ^ 1),
+                            (uint8_t)(v.steps | (1 << face))});
+    }
+  }
+}
+
+void World::Draw(Vector3 playerPos) {
+  if (headless)
+    return;
+  ProfileScope scope(PROFILE_WORLD_DRAW);
+
+  // Same matrices BeginMode3D gave the GPU, so culling matches the view
+  Frustum frustum =
+      FrustumFromMatrices(rlGetMatrixModelview(), rlGetMatrixProjection());
+  CollectVisibleChunks(playerPos, frustum, visibleChunks);
+
+  // Chunks bypass raylib's batch, so flush whatever it holds first
+  rlDrawRenderBatchActive();
+  rlEnableShader(chunkShader.id);
+  rlSetUniformMatrix(chunkShader.locs[SHADER_LOC_MATRIX_VIEW],
+                     rlGetMatrixModelview());
+  rlSetUniformMatrix(chunkShader.locs[SHADER_LOC_MATRIX_PROJECTION],
+                     rlGetMatrixProjection());
+  int atlasSlot = 0;
+  rlActiveTextureSlot(atlasSlot);
+  rlEnableTexture(atlasTexture.id);
+  rlSetUniform(chunkShader.locs[SHADER_LOC_MAP_DIFFUSE], &atlasSlot,
+               RL_SHADER_UNIFORM_SAMPLER2D, 1);
+
+  for (const ChunkCoord &c : visibleChunks) {
+    const Chunk &chunk = *FindChunk(c.cx, c.cy, c.cz);
+    float origin[3] = {(float)(c.cx * CHUNK_SIZE), (float)(c.cy * CHUNK_SIZE),
+                       (float)(c.cz * CHUNK_SIZE)};
+    rlSetUniform(chunkOriginLoc, origin, RL_SHADER_UNIFORM_VEC3, 1);
+    rlEnableVertexArray(chunk.mesh.vaoId);
+    rlDrawVertexArrayElements(0, chunk.mesh.indexCount, 0);
+  }
+
+  rlDisableVertexArray();
+  rlDisableTexture();
+  rlDisableShader();
+}
+
+Block World::GetBlock(int x, int y, int z) {
+  if (y < 0 || y >= WORLD_HEIGHT)
+    return {BLOCK_AIR};
+  ChunkColumn *column = FindColumn(BlockToChunk(x), BlockToChunk(z));
+  if (!column)
+    return {BLOCK_AIR};
+  return {Blocks(column->chunks[y / CHUNK_SIZE])
+              .Get(BlockToLocal(x), y % CHUNK_SIZE, BlockToLocal(z))};
+}
+
+size_t World::GetVoxelMemoryUsage() {
+  size_t total = 0;
+  for (auto &entry : columns) {
+    if (entry.second->state == COLUMN_GENERATING ||
+        entry.second->state == COLUMN_SAVING)
+      continue; // Owned by a worker or the I/O thread
+    for (const Chunk &chunk : entry.second->chunks)
+      total += chunk.blocks.MemoryUsage();
+  }
+  return total;
+}
+
+size_t World::GetLightMemoryUsage() {
+  size_t total = 0;
+  for (auto &entry : columns) {
+    if (entry.second->state == COLUMN_GENERATING ||
+        entry.second->state == COLUMN_SAVING)
+      continue; // Owned by a worker or the I/O thread
+    for (const Chunk &chunk : entry.second->chunks)
+      total += chunk.skyLight.MemoryUsage() + chunk.blockLight.MemoryUsage();
+  }
+  return total;
+}
+
+// Amanatides-Woo voxel traversal: step cell to cell along the ray, always
+// crossing the nearest boundary next, and stop at the first non-air block.
+// Blocks are centred on integer coordinates (x - 0.5 to x + 0.5), so the
+// origin is shifted by half a block to put cell boundaries on integers.
+World::WorldRayHit World::GetRayCollision(Ray ray, float maxDistance) {
+  ProfileScope scope(PROFILE_RAYCAST);
+  WorldRayHit result = {false};
+  if (!(maxDistance > 0.0f)) // NaN too
+    return result;
+  maxDistance = std::min(maxDistance, RAYCAST_DISTANCE_LIMIT);
+
+  float length = sqrtf(ray.direction.x * ray.direction.x +
+                       ray.direction.y * ray.direction.y +
+                       ray.direction.z * ray.direction.z);
+  if (length == 0.0f)
+    return result;
+
+  float origin[3] = {ray.position.x + 0.5f, ray.position.y + 0.5f,
+                     ray.position.z + 0.5f};
+  float dir[3] = {ray.direction.x / length, ray.direction.y / length,
+                  ray.direction.z / length};
+  int cell[3];
+  int step[3];
+  float tMax[3];   // Distance to the next boundary on each axis
+  float tDelta[3]; // Distance between boundaries on each axis
+  for (int a = 0; a < 3; a++) {
+    cell[a] = (int)floorf(origin[a]);
+    if (dir[a] > 0) {
+      step[a] = 1;
+      tDelta[a] = 1.0f / dir[a];
+      tMax[a] = (cell[a] + 1 - origin[a]) * tDelta[a];
+    } else if (dir[a] < 0) {
+      step[a] = -1;
+      tDelta[a] = -1.0f / dir[a];
+      tMax[a] = (origin[a] - cell[a]) * tDelta[a];
+    } else {
+      step[a] = 0;
+      tDelta[a] = INFINITY;
+      tMax[a] = INFINITY;
+    }
+  }
+
+  // Starting inside a block: report it at distance 0 with no face
+  int axis = -1;
+  float t = 0.0f;
+  while (!GetBlock(cell[0], cell[1], cell[2]).IsActive()) {
+    axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2)
+                             : (tMax[1] < tMax[2] ? 1 : 2);
+    t = tMax[axis];
+    if (t > maxDistance)
+      return result;
+    cell[axis] += step[axis];
+    tMax[axis] += tDelta[axis];
+
+    // Above or below the world and heading further out: nothing left to hit
+    if (axis == 1 && ((cell[1] < 0 && step[1] < 0) ||
+                      (cell[1] >= WORLD_HEIGHT && step[1] > 0)))
+      return result;
+  }
+
+  result.hit = true;
+  result.x = cell[0];
+  result.y = cell[1];
+  result.z = cell[2];
+  result.position = {(float)cell[0], (float)cell[1], (float)cell[2]};
+  result.normal = {0, 0, 0};
+  if (axis >= 0) {
+    float n[3] = {0, 0, 0};
+    n[axis] = (float)-step[axis]; // The face we came through
+    result.normal = {n[0], n[1], n[2]};
+  }
+  result.distance = t;
+  return result;
+}
+
+World::BoxMove World::MoveBox(BoundingBox box, Vector3 motion) {
+  BoxMove result = {{0, 0, 0}, false, false, false, 0};
+  // Shifted like the raycast, so block i spans [i, i + 1) on every axis
+  float lo[3] = {box.min.x + 0.5f, box.min.y + 0.5f, box.min.z + 0.5f};
+  float hi[3] = {box.max.x + 0.5f, box.max.y + 0.5f, box.max.z + 0.5f};
+  float move[3] = {motion.x, motion.y, motion.z};
+  bool hit[3] = {false, false, false};
+
+  const int order[3] = {0, 2, 1};
+  for (int k = 0; k < 3; k++) {
+    int a = order[k];
+    float d = move[a];
+    if (d == 0.0f)
+      continue;
+    // Cross-section of the box on the other two axes, in cells
+    int b = (a + 1) % 3, c = (a + 2) % 3;
+    int b0 = (int)floorf(lo[b]), b1 = (int)ceilf(hi[b]) - 1;
+    int c0 = (int)floorf(lo[c]), c1 = (int)ceilf(hi[c]) - 1;
+
+    // Layers the leading face enters, nearest first
+    int step = d > 0 ? 1 : -1;
+    int first = d > 0 ? (int)ceilf(hi[a]) : (int)floorf(lo[a]) - 1;
+    int last = d > 0 ? (int)ceilf(hi[a] + d) - 1 : (int)floorf(lo[a] + d);
+    for (int i = first; (last - i) * step >= 0 && !hit[a]; i += step) {
+      int cell[3];
+      cell[a] = i;
+      for (cell[b] = b0; cell[b] <= b1 && !hit[a]; cell[b]++) {
+        for (cell[c] = c0; cell[c] <= c1 && !hit[a]; cell[c]++) {
+          result.blocksTested++;
+          hit[a] = GetBlock(cell[0], cell[1], cell[2]).IsSolid();
         }
       }
+      // Up to the layer's face, never backwards if already within the skin
+      if (hit[a])
+        d = d > 0 ? fmaxf(i - hi[a] - COLLISION_SKIN, 0.0f)
+                  : fminf(i + 1 - lo[a] + COLLISION_SKIN, 0.0f);
     }
+    lo[a] += d;
+    hi[a] += d;
+    move[a] = d;
   }
-  return closestHit;
+
+  result.delta = {move[0], move[1], move[2]};
+  result.hitX = hit[0];
+  result.hitY = hit[1];
+  result.hitZ = hit[2];
+  return result;
 }
 
 void World::SetBlock(int x, int y, int z, bool active, BlockType type) {
-  if (x >= 0 && x < WORLD_WIDTH && y >= 0 && y < WORLD_HEIGHT && z >= 0 &&
-      z < WORLD_DEPTH) {
-    grid[x][y][z].active = active;
-    grid[x][y][z].type = type;
-
-    int cx = x / CHUNK_SIZE;
-    int cy = y / CHUNK_SIZE;
-    int cz = z / CHUNK_SIZE;
-    if (cx >= 0 && cx < WORLD_WIDTH / CHUNK_SIZE && cy >= 0 &&
-        cy < WORLD_HEIGHT / CHUNK_SIZE && cz >= 0 &&
-        cz < WORLD_DEPTH / CHUNK_SIZE) {
-      chunks[cx][cy][cz].dirty = true;
-
-      if (x % CHUNK_SIZE == 0 && cx > 0)
-        chunks[cx - 1][cy][cz].dirty = true;
-      if (x % CHUNK_SIZE == CHUNK_SIZE - 1 && cx < WORLD_WIDTH / CHUNK_SIZE - 1)
-        chunks[cx + 1][cy][cz].dirty = true;
-      if (y % CHUNK_SIZE == 0 && cy > 0)
-        chunks[cx][cy - 1][cz].dirty = true;
-      if (y % CHUNK_SIZE == CHUNK_SIZE - 1 &&
-          cy < WORLD_HEIGHT / CHUNK_SIZE - 1)
-        chunks[cx][cy + 1][cz].dirty = true;
-      if (z % CHUNK_SIZE == 0 && cz > 0)
-        chunks[cx][cy][cz - 1].dirty = true;
-      if (z % CHUNK_SIZE == CHUNK_SIZE - 1 && cz < WORLD_DEPTH / CHUNK_SIZE - 1)
-        chunks[cx][cy][cz + 1].dirty = true;
+  if (y < 0 || y >= WORLD_HEIGHT)
+    return;
+  int cx = BlockToChunk(x);
+  int cy = y / CHUNK_SIZE;
+  int cz = BlockToChunk(z);
+  ChunkColumn *column = FindColumn(cx, cz);
+  if (!column || column->state != COLUMN_READY)
+    return; // Trees still to come would land on top of the edit
+  column->unsaved = true;
+  int lx = BlockToLocal(x);
+  int ly = y % CHUNK_SIZE;
+  int lz = BlockToLocal(z);
+  ChunkSection &blocks = Blocks(column->chunks[cy]);
+  BlockType before = blocks.Get(lx, ly, lz);
+  blocks.Set(lx, ly, lz, active ? type : BLOCK_AIR);
+  relightCellCount = 0;
+  if (QueueRelight(x, y, z, before, active ? type : BLOCK_AIR))
+    RelightQueued(true);
+  if (before != (active ? type : BLOCK_AIR))
+    WakeWater(x, y, z);
+
+  // Neighbours across a face, edge or corner get remeshed too: their AO
+  // reads the cells diagonal to their faces
+  MarkEditedBox(x, y, z, x, y, z);
+}
+
+// Edits jump the rebuild queue so the player sees them the next frame
+void World::MarkEdited(int cx, int cy, int cz) {
+  Chunk *chunk = FindChunk(cx, cy, cz); // Null past the top or bottom
+  if (!chunk)
+    return;
+  chunk->dirty = true;
+  chunk->edited = true;
+}
+
+void World::FillBox(int x0, int y0, int z0, int x1, int y1, int z1,
+                    BlockType type) {
+  if (x0 > x1)
+    std::swap(x0, x1);
+  if (y0 > y1)
+    std::swap(y0, y1);
+  if (z0 > z1)
+    std::swap(z0, z1);
+  y0 = std::max(y0, 0);
+  y1 = std::min(y1, WORLD_HEIGHT - 1);
+  if (y0 > y1)
+    return;
+  // Air and opaque blocks give the box's light without a look at each cell
+  bool bulkLight = BlockLightEmission(type) == 0 &&
+                   (BlockLightOpacity(type) == 0 ||
+                    BlockLightOpacity(type) >= LIGHT_MAX);
+
+  for (int cx = BlockToChunk(x0); cx <= BlockToChunk(x1); cx++) {
+    for (int cz = BlockToChunk(z0); cz <= BlockToChunk(z1); cz++) {
+      ChunkColumn *column = FindColumn(cx, cz);
+      if (!column || column->state != COLUMN_READY)
+        continue;
+      column->unsaved = true;
+      // The box's part of this column, in local coordinates
+      int lx0 = std::max(x0 - cx * CHUNK_SIZE, 0);
+      int lx1 = std::min(x1 - cx * CHUNK_SIZE, CHUNK_SIZE - 1);
+      int lz0 = std::max(z0 - cz * CHUNK_SIZE, 0);
+      int lz1 = std::min(z1 - cz * CHUNK_SIZE, CHUNK_SIZE - 1);
+      for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; cy++) {
+        int ly0 = std::max(y0 - cy * CHUNK_SIZE, 0);
+        int ly1 = std::min(y1 - cy * CHUNK_SIZE, CHUNK_SIZE - 1);
+        ChunkSection &blocks = Blocks(column->chunks[cy]);
+        // A part that is all one type needs no look at each cell
+        if (!bulkLight &&
+            (!blocks.IsUniform() ||
+             BlockLightOpacity(blocks.GetUniformType()) !=
+                 BlockLightOpacity(type) ||
+             BlockLightEmission(blocks.GetUniformType()) !=
+                 BlockLightEmission(type))) {
+          for (int ly = ly0; ly <= ly1; ly++)
+            for (int lz = lz0; lz <= lz1; lz++)
+              for (int lx = lx0; lx <= lx1; lx++)
+                QueueRelight(cx * CHUNK_SIZE + lx, cy * CHUNK_SIZE + ly,
+                             cz * CHUNK_SIZE + lz, blocks.Get(lx, ly, lz),
+                             type);
+        }
+        blocks.FillBox(lx0, ly0, lz0, lx1, ly1, lz1, type);
+      }
+    }
+  }
+  if (bulkLight)
+    RelightFilledBox(x0, y0, z0, x1, y1, z1, type);
+  else
+    RelightQueued(true);
+  MarkEditedBox(x0, y0, z0, x1, y1, z1);
+
+  // Only the box's outer layer touches blocks that weren't filled too
+  for (int y = y0; y <= y1; y++) {
+    for (int z = z0; z <= z1; z++) {
+      if (y == y0 || y == y1 || z == z0 || z == z1) {
+        for (int x = x0; x <= x1; x++)
+          WakeWater(x, y, z);
+      } else {
+        WakeWater(x0, y, z);
+        if (x1 != x0)
+          WakeWater(x1, y, z);
+      }
+    }
+  }
+}
+
+void World::FillColumn(int x, int z, int y0, int y1, BlockType type) {
+  FillBox(x, y0, z, x, y1, z, type);
+}
+
+// Whether a chunk's edits reach its neighbour d (-1, 0 or 1) along the axis
+// whose negative face is neg; the positive face is the bit after it
+static bool EditReaches(int faces, int neg, int d) {
+  return d == 0 || (faces & (1 << (neg + (d > 0))));
+}
+
+void World::ApplyEdits(const std::vector<BlockEdit> &edits) {
+  // Write everything first, noting per chunk which faces were touched. The
+  // flag keeps each chunk in the list once, without a set or a sort.
+  editedChunks.clear();
+  for (const BlockEdit &e : edits) {
+    if (e.y < 0 || e.y >= WORLD_HEIGHT)
+      continue;
+    int cx = BlockToChunk(e.x);
+    int cz = BlockToChunk(e.z);
+    ChunkColumn *column = FindColumn(cx, cz); // Cached for runs of a column
+    if (!column || column->state != COLUMN_READY)
+      continue;
+    column->unsaved = true;
+    int lx = BlockToLocal(e.x);
+    int ly = e.y % CHUNK_SIZE;
+    int lz = BlockToLocal(e.z);
+    Chunk &chunk = column->chunks[e.y / CHUNK_SIZE];
+    ChunkSection &blocks = Blocks(chunk);
+    BlockType before = blocks.Get(lx, ly, lz);
+    QueueRelight(e.x, e.y, e.z, before, e.type);
+    blocks.Set(lx, ly, lz, e.type);
+    if (before != e.type)
+      WakeWater(e.x, e.y, e.z);
+
+    if (!(chunk.editFaces & CHUNK_EDIT_TOUCHED)) {
+      chunk.editFaces = CHUNK_EDIT_TOUCHED;
+      editedChunks.push_back({&chunk, {cx, e.y / CHUNK_SIZE, cz}});
     }
+    chunk.editFaces |= (lx == 0) << CHUNK_FACE_NEG_X |
+                       (lx == CHUNK_SIZE - 1) << CHUNK_FACE_POS_X |
+                       (ly == 0) << CHUNK_FACE_NEG_Y |
+                       (ly == CHUNK_SIZE - 1) << CHUNK_FACE_POS_Y |
+                       (lz == 0) << CHUNK_FACE_NEG_Z |
+                       (lz == CHUNK_SIZE - 1) << CHUNK_FACE_POS_Z;
+  }
+
+  RelightQueued(true);
+
+  // Then each edited chunk once, plus the neighbours across touched faces
+  // and the edges and corners between them, whose AO reads diagonally. Two
+  // faces touched by different blocks mark their edge too; that's cheap.
+  for (const EditedChunk &edited : editedChunks) {
+    Chunk &chunk = *edited.chunk;
+    const ChunkCoord &c = edited.coord;
+    chunk.dirty = true;
+    chunk.edited = true;
+    int faces = chunk.editFaces;
+    for (int dx = -1; dx <= 1; dx++)
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dz = -1; dz <= 1; dz++)
+          if ((dx || dy || dz) && EditReaches(faces, CHUNK_FACE_NEG_X, dx) &&
+              EditReaches(faces, CHUNK_FACE_NEG_Y, dy) &&
+              EditReaches(faces, CHUNK_FACE_NEG_Z, dz))
+            MarkEdited(c.cx + dx, c.cy + dy, c.cz + dz);
+    chunk.editFaces = 0;
   }
 }
+
+// Blocks whose next water state can depend on a block: itself, the six
+// around it, then the four diagonally above its sides (water only spreads
+// sideways over something solid)
+static const int WATER_DEPENDENTS[11][3] = {
+    {0, 0, 0},  {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1},
+    {0, 0, 1},  {-1, 1, 0}, {1, 1, 0}, {0, 1, -1}, {0, 1, 1}};
+static const int WATER_SIDES[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+static uint64_t WaterKey(int x, int y, int z) {
+  return ((uint64_t)(x & 0xFFFFFFF) << 36) |
+         ((uint64_t)(z & 0xFFFFFFF) << 8) | (uint64_t)y;
+}
+
+// A changed block only matters to water if there is some at or beside it
+void World::WakeWater(int x, int y, int z) {
+  for (int i = 0; i < 7; i++) {
+    const int *d = WATER_DEPENDENTS[i];
+    if (IsWater(GetBlock(x + d[0], y + d[1], z + d[2]).type)) {
+      waterWake.push_back({x, y, z});
+      return;
+    }
+  }
+}
+
+// Water falls into the cell below at full level, and spreads sideways a
+// level weaker per step, but only from a source or where it can't fall.
+// Flowing water nothing feeds any more drains, a step further each tick.
+BlockType World::FlowWater(int x, int y, int z, BlockType type) {
+  if (type != BLOCK_AIR && !IsFlowingWater(type))
+    return type; // Sources and other blocks stay put
+  if (IsWater(GetBlock(x, y + 1, z).type))
+    return FlowingWater(WATER_FULL);
+  int level = 0;
+  for (const int *d : WATER_SIDES) {
+    BlockType side = GetBlock(x + d[0], y, z + d[1]).type;
+    if (side == BLOCK_WATER ||
+        (IsWater(side) && GetBlock(x + d[0], y - 1, z + d[1]).IsSolid()))
+      level = std::max(level, WaterLevel(side) - 1);
+  }
+  return FlowingWater(level);
+}
+
+void World::TickWater() {
+  ProfileScope scope(PROFILE_WATER_TICK);
+  int64_t start = Profiler::NowNs();
+  for (const WaterCell &c : waterWake) {
+    for (const int *d : WATER_DEPENDENTS) {
+      int x = c.x + d[0], y = c.y + d[1], z = c.z + d[2];
+      if (y >= 0 && y < WORLD_HEIGHT &&
+          waterQueued.insert(WaterKey(x, y, z)).second)
+        waterActive.push_back({x, y, z});
+    }
+  }
+  waterWake.clear();
+
+  // Every next state comes from the blocks as they were before the tick,
+  // so the order cells are looked at doesn't matter
+  int count = std::min((int)(waterActive.size() - waterActiveHead),
+                       WATER_TICK_BUDGET);
+  waterEdits.clear();
+  for (int i = 0; i < count; i++) {
+    const WaterCell &c = waterActive[waterActiveHead++];
+    waterQueued.erase(WaterKey(c.x, c.y, c.z));
+    BlockType type = GetBlock(c.x, c.y, c.z).type;
+    BlockType next = FlowWater(c.x, c.y, c.z, type);
+    if (next != type)
+      waterEdits.push_back({c.x, c.y, c.z, next});
+  }
+  // Ticked cells are dropped once they are half the array, so each is moved
+  // at most once on average, not once per tick of a long backlog
+  if (waterActiveHead * 2 >= waterActive.size()) {
+    waterActive.erase(waterActive.begin(),
+                      waterActive.begin() + waterActiveHead);
+    waterActiveHead = 0;
+  }
+  ApplyEdits(waterEdits); // Wakes the cells around each change
+
+  lastWaterTick.cells = count;
+  lastWaterTick.changed = (int)waterEdits.size();
+  lastWaterTick.pending = (int)(waterActive.size() - waterActiveHead);
+  lastWaterTick.ms = (Profiler::NowNs() - start) / 1000000.0;
+}
+
+// Every chunk holding part of the box or touching it at a face, edge or
+// corner, i.e. the chunks overlapping the box grown by one block
+void World::MarkEditedBox(int x0, int y0, int z0, int x1, int y1, int z1) {
+  for (int cx = BlockToChunk(x0 - 1); cx <= BlockToChunk(x1 + 1); cx++)
+    for (int cy = BlockToChunk(y0 - 1); cy <= BlockToChunk(y1 + 1); cy++)
+      for (int cz = BlockToChunk(z0 - 1); cz <= BlockToChunk(z1 + 1); cz++)
+        MarkEdited(cx, cy, cz);
+}
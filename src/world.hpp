@@ -1,72 +1,538 @@
 #pragma once
 #include "../vendor/raylib/src/raylib.h"
+#include "block.hpp"
+#include "chunk_section.hpp"
+#include "frustum.hpp"
+#include "light_section.hpp"
+#include "mesher.hpp"
+#include "region.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#define WORLD_WIDTH 1024
+// The world is unbounded on x and z and generated one chunk column at a time
+// around the player. Height stays fixed.
 #define WORLD_HEIGHT 256
-#define WORLD_DEPTH 1024
-#define CHUNK_SIZE 16
-
-enum BlockType {
-  BLOCK_AIR = 0,
-  BLOCK_DIRT,
-  BLOCK_GRASS,
-  BLOCK_STONE,
-  BLOCK_WOOD,
-  BLOCK_SAND,
-  BLOCK_LEAVES,
-  BLOCK_WATER
-};
+#define WORLD_COLUMN_CHUNKS (WORLD_HEIGHT / CHUNK_SIZE)
+#define ISLAND_SIZE 1024 // Land covers [0, ISLAND_SIZE) on x and z, then sea
+#define DEFAULT_WORLD_SEED 1337u
+// Height noise: fBm octaves, in noise units per block
+#define TERRAIN_NOISE_SCALE (2.0f / ISLAND_SIZE)
+#define TERRAIN_NOISE_OCTAVES 6
+
+// Columns are generated out to render distance + 2 (a meshed chunk needs its
+// neighbours finished, and they need theirs for trees) and evicted past
+// render distance + COLUMN_UNLOAD_MARGIN
+#define COLUMN_UNLOAD_MARGIN 3
+// Terrain jobs queued on the workers at once, so the queue keeps following
+// the player instead of finishing a ring they already left
+#define MAX_GENERATE_JOBS_IN_FLIGHT 32
+
+// Meshing runs on worker threads; the main thread only snapshots and uploads
+#define MAX_MESH_JOBS_IN_FLIGHT 64
+#define MESH_UPLOAD_BUDGET 0.004 // Seconds of GPU upload per frame
+#define MESH_SCHEDULE_BUDGET 0.002 // Seconds of snapshotting per frame
+// Dirty chunks off screen are rebuilt as if this many times further away
+#define MESH_OFF_SCREEN_BIAS 2.0f
+
+// Chunks around the player that are meshed and drawn, in each direction
+#define DEFAULT_RENDER_DISTANCE 4
+#define MIN_RENDER_DISTANCE 1
+#define MAX_RENDER_DISTANCE 16
 
-struct Block {
-  bool active;
-  BlockType type;
+#define RAYCAST_MAX_DISTANCE 8.0f // Default reach in blocks
+// Longest reach GetRayCollision takes, three of the furthest render distances;
+// longer (infinite too) is clamped, as unloaded land reads as air forever
+#define RAYCAST_DISTANCE_LIMIT (3.0f * MAX_RENDER_DISTANCE * CHUNK_SIZE)
+#define COLLISION_SKIN 0.001f    // Gap MoveBox leaves before a face it hits
+
+// Seconds between autosaves of new and edited columns, with a save open
+#define AUTOSAVE_INTERVAL 30.0
+
+// Flowing water ticks this many times a second, each looking at no more
+// than WATER_TICK_BUDGET cells; the rest wait for the next tick
+#define WATER_TICK_RATE 5.0
+#define WATER_TICK_BUDGET 4096
+
+// GPU buffers for one chunk's packed vertices (the index buffer is shared)
+struct ChunkMesh {
+  unsigned int vaoId;
+  unsigned int vboId;
+  int indexCount;
 };
 
 struct Chunk {
-  Model model;
-  bool active; // If it has any blocks
-  bool dirty;  // Needs rebuild
-  // We don't store blocks here, we keep the global grid for simplicity of logic
-  // Just use the Chunk to hold the simplified mesh
+  ChunkMesh mesh;
+  bool active;         // If it has any blocks
+  bool dirty;          // Needs rebuild
+  bool edited;         // Dirtied by SetBlock after generation, rebuilt first
+  bool meshing;        // Snapshot handed to a worker, mesh not uploaded yet
+  uint8_t minY, maxY;  // Local Y extent of the mesh, for culling
+  uint16_t visibility; // Face pairs joined by open cells (ChunkFacePairBit)
+  uint8_t editFaces;   // ApplyEdits scratch: CHUNK_EDIT_TOUCHED | face bits
+  uint8_t lightFaces;  // Same for faces with relit cells on them
+  ChunkSection blocks; // Voxel storage, uniform chunks cost no array
+  // Loaded from a mapped save and not decoded yet: the section's Encode
+  // stream, in place in the mapping. World::Blocks decodes it into blocks.
+  const uint8_t *encoded;
+  uint32_t encodedSize;
+  // Light, worked out once the column is READY
+  LightSection skyLight;   // From the sky
+  LightSection blockLight; // From light-emitting blocks
+};
+
+// Chunk::editFaces flag for a chunk already in the ApplyEdits list, and
+// lightFaces for one in the relit list
+#define CHUNK_EDIT_TOUCHED (1 << CHUNK_FACE_COUNT)
+
+// Generation runs in two passes. Terrain is generated on a worker and only
+// records where trees go; trees are placed once the columns around have
+// terrain too, so canopies can reach across column borders. Columns loaded
+// from a save come back in the state they were saved in.
+enum ColumnState {
+  COLUMN_GENERATING, // Terrain or load job on a worker owns the blocks
+  COLUMN_TERRAIN,    // Terrain readable, trees not placed yet
+  COLUMN_READY,      // Trees of the 3x3 around it placed; meshed and edited
+  COLUMN_SAVING      // Evicted, being written by the I/O thread
+};
+
+// Flags in the first byte of a saved column record
+#define COLUMN_RECORD_READY 1 // Trees placed, saved READY
+#define COLUMN_RECORD_LIGHT 2 // Light follows the blocks
+
+// Trunk base and height of a tree, in its column's local coordinates
+struct TreeSite {
+  uint8_t lx, y, lz;
+  uint8_t height;
+};
+
+// A full-height stack of chunks, the unit of loading and eviction
+struct ChunkColumn {
+  int cx, cz;
+  ColumnState state;
+  bool unsaved;                // Different from the save (new, edited, relit)
+  bool fromDisk;               // Set by the job: loaded, not generated
+  ColumnState landState;       // TERRAIN or READY, also while SAVING
+  // Sides (1 << CHUNK_FACE_*) whose column across was READY when this one
+  // was saved: the saved light agrees with that column's there, unless
+  // either side went stale since
+  uint8_t joinedSides;
+  // Sides whose border light changed while the column across wasn't READY,
+  // so that one's saved light may be out of date there
+  uint8_t staleSides;
+  std::vector<TreeSite> trees; // Rooted in this column, from GenerateColumn
+  Chunk chunks[WORLD_COLUMN_CHUNKS];
+};
+
+struct ChunkCoord {
+  int cx, cy, cz;
+};
+
+// One write for World::ApplyEdits
+struct BlockEdit {
+  int x, y, z;
+  BlockType type; // BLOCK_AIR removes
+};
+
+// Chunk (or column) index of a block coordinate, rounding towards -infinity
+inline int BlockToChunk(int v) {
+  return v >= 0 ? v / CHUNK_SIZE : (v + 1) / CHUNK_SIZE - 1;
+}
+// Position inside that chunk, always 0 to CHUNK_SIZE - 1
+inline int BlockToLocal(int v) { return v - BlockToChunk(v) * CHUNK_SIZE; }
+
+// Chunk range [min, max) on each axis, clamped to the world height
+struct ChunkWindow {
+  int minCX, maxCX;
+  int minCY, maxCY;
+  int minCZ, maxCZ;
+
+  bool IsEmpty() const {
+    return minCX >= maxCX || minCY >= maxCY || minCZ >= maxCZ;
+  }
+  bool Contains(int cx, int cy, int cz) const {
+    return cx >= minCX && cx < maxCX && cy >= minCY && cy < maxCY &&
+           cz >= minCZ && cz < maxCZ;
+  }
+  int GetVolume() const {
+    return (maxCX - minCX) * (maxCY - minCY) * (maxCZ - minCZ);
+  }
+  // Dense index of a chunk inside the window, 0 to GetVolume() - 1
+  int Index(int cx, int cy, int cz) const {
+    return ((cx - minCX) * (maxCY - minCY) + (cy - minCY)) * (maxCZ - minCZ) +
+           (cz - minCZ);
+  }
+};
+
+// One finished autosave. The main thread only pays for snapshotMs; the rest
+// is on the I/O thread.
+struct SaveStats {
+  int columns;       // Snapshotted for this save
+  size_t bytes;      // Region files written, evictions since the last included
+  double snapshotMs; // Main thread: copying the columns
+  double writeMs;    // I/O thread: encoding, writing, fsync and rename
+};
+
+// One water tick, all on the main thread
+struct WaterStats {
+  int cells;   // Looked at, at most WATER_TICK_BUDGET
+  int changed; // Filled, drained or changed level
+  int pending; // Left in the active set for later ticks
+  double ms;   // Relighting and marking chunks to remesh included
 };
 
 class World {
 public:
   World();
-  void Init();
-  void Update(Vector3 playerPos); // Added playerPos for future loading logic
+  // Headless skips every GPU resource (textures, shader, mesh uploads) so the
+  // world can be generated and meshed without a window, e.g. by the bench.
+  // Update then waits for terrain, meshes on the calling thread without a
+  // time budget and only records mesh bounds. Init itself generates nothing.
+  // Terrain is a pure function of the seed: the same seed gives the same
+  // world whatever order columns are generated in. workerThreads <= 0 picks
+  // ThreadPool::DefaultThreadCount().
+  void Init(bool headless = false, uint32_t seed = DEFAULT_WORLD_SEED,
+            int workerThreads = 0);
+  // Streams columns around the player (StreamColumns), then rebuilds dirty
+  // chunks within render distance, edited ones first, then nearest first with
+  // on-screen chunks ahead. Stops when the frame's MESH_SCHEDULE_BUDGET is
+  // spent (headless: only when all are rebuilt).
+  void Update(Vector3 playerPos);
+  // Evicts columns beyond the unload radius, queues terrain jobs for missing
+  // ones in range, nearest first, and places trees in columns whose
+  // neighbours have landed. Columns within 2 of the player's are generated
+  // right away so the ground the player stands on and edits is finished.
+  // Headless waits for every job. Edits in evicted columns are dropped.
+  void StreamColumns(Vector3 playerPos);
+  // Keeps the world in region files under `directory`: columns are loaded
+  // from there instead of generated. New or edited columns go back on the
+  // I/O thread when evicted and on each Autosave, the rest on Unload. Call
+  // right after Init. An existing save brings its own seed.
+  // Read only opens an existing save with its region files memory-mapped,
+  // for big pre-built worlds: loading a column decodes only its uniform
+  // sections, the rest on first access (GetBlock, edits, meshing), so the
+  // OS page cache holds the world instead of the heap. Nothing is saved;
+  // edits last until their column is evicted.
+  bool OpenSave(const char *directory, bool readOnly = false);
+  // Copies every new or edited column (one memcpy per section) and hands the
+  // copies to the I/O thread, which encodes them and commits every region
+  // with changes, evictions included. Never waits on the disk: skipped if
+  // the last autosave is still writing. Update calls it every
+  // AUTOSAVE_INTERVAL; headless worlds only save when asked.
+  void Autosave();
+  void WaitForAutosave(); // Blocks until it's on disk, for tests and bench
+  SaveStats GetLastSaveStats();
   void Draw(Vector3 playerPos);   // Added playerPos for culling logic
   void Unload();
 
   Texture2D GetBlockTexture(BlockType type);
 
+  // Blocks in columns that aren't loaded read as air and ignore writes.
+  // Columns still waiting for trees can be read but not written.
   Block GetBlock(int x, int y, int z);
+  // Also relights around the block if it changes how light passes or is
+  // given off, see GetRelightCellCount
   void SetBlock(int x, int y, int z, bool active, BlockType type);
 
+  // Bulk edits with the same rules as SetBlock, but the chunks to remesh are
+  // worked out once per call instead of once per block, and the changed
+  // blocks are relit together. Box corners are inclusive, in any order; box
+  // and column fills write each chunk's part in storage order with one
+  // palette lookup.
+  void FillBox(int x0, int y0, int z0, int x1, int y1, int z1, BlockType type);
+  void FillColumn(int x, int z, int y0, int y1, BlockType type);
+  // Applied in order, so a later edit to the same block wins. Fastest when
+  // edits to one chunk come together.
+  void ApplyEdits(const std::vector<BlockEdit> &edits);
+
+  // Sky and block light, 0 to LIGHT_MAX. Light is worked out once a column
+  // is READY (its trees placed): inside the column on its own first, then
+  // across its borders with the READY columns around. It is saved with the
+  // column and only joined again on load. Edits relight just the cells
+  // their light reached, through a removal and a refill queue. Columns that
+  // aren't READY read as dark.
+  int GetSkyLight(int x, int y, int z);
+  int GetBlockLight(int x, int y, int z);
+  // Cells the last edit's relight visited, both channels. Light reaches 15
+  // blocks at most, so that's bounded by the cells within 15 steps of the
+  // changed ones, plus, for sky light, the open shafts straight below them.
+  int GetRelightCellCount() { return relightCellCount; }
+
+  // Flowing water: a cellular automaton over the active set, the cells
+  // around blocks that changed next to water. Air and flowing water fill,
+  // drain or change level from the water above and beside them; sources
+  // (BLOCK_WATER) never change. A tick takes the oldest WATER_TICK_BUDGET
+  // cells and writes what changed as one ApplyEdits, so each chunk is
+  // relit and remeshed once per tick, and the changes wake the cells around
+  // them for the next. Update ticks at WATER_TICK_RATE, at most once a
+  // frame; headless worlds only tick when asked.
+  void TickWater();
+  WaterStats GetLastWaterStats() { return lastWaterTick; }
+
+  // Bytes held by voxel storage (sections + allocated cell arrays)
+  size_t GetVoxelMemoryUsage();
+  size_t GetLightMemoryUsage(); // Light sections, both channels
+  int GetLoadedColumnCount() { return (int)columns.size(); }
+  int GetGeneratedColumnCount() { return columnsGenerated; }
+  int GetReadColumnCount() { return columnsRead; } // Loaded from the save
+  uint32_t GetSeed() { return seed; }
+
+  // Meshed chunks within render distance whose mesh bounds touch the
+  // frustum, i.e. exactly what Draw issues a draw call for. With occlusion
+  // culling on, only chunks reached by the visibility walk from the eye's
+  // chunk count. Deterministic, works headless.
+  void CollectVisibleChunks(Vector3 playerPos, const Frustum &frustum,
+                            std::vector<ChunkCoord> &out);
+  // Meshed chunks in range considered by the last CollectVisibleChunks
+  int GetCandidateChunkCount() { return candidateChunks; }
+  int GetDrawnChunkCount() { return (int)visibleChunks.size(); }
+
+  // In chunks, clamped to MIN/MAX_RENDER_DISTANCE. Chunks that come into
+  // range are meshed ring by ring from the player outwards.
+  void SetRenderDistance(int chunks);
+  int GetRenderDistance() { return renderDistance; }
+
+  void SetOcclusionCulling(bool enabled) { occlusionCulling = enabled; }
+  bool GetOcclusionCulling() { return occlusionCulling; }
+
+  // Switching modes remeshes every chunk
+  void SetMeshingMode(MeshingMode mode);
+  MeshingMode GetMeshingMode() { return meshingMode; }
+
+  // Mesh job buffers allocated so far; flat once meshing reaches steady state
+  int GetMeshAllocationCount() { return meshAllocations; }
+
+  // Snapshot and mesh one chunk on the calling thread with the current mode.
+  // CPU only, nothing is uploaded; works headless.
+  void BuildChunkMeshNow(int cx, int cy, int cz, ChunkSnapshot &snapshot,
+                         ChunkMeshData &out);
+
   // Raycast support
   struct WorldRayHit {
     bool hit;
     Vector3 position; // Center of the block hit
-    Vector3 normal;   // Normal of the face hit
+    Vector3 normal;   // Normal of the face hit, zero if the ray starts inside
     int x, y, z;      // Grid indices
-    float distance;
+    float distance;   // Along the normalized ray direction
   };
 
-  WorldRayHit GetRayCollision(Ray ray);
+  // First non-air block along the ray within maxDistance (in blocks, the
+  // direction need not be normalized). Cost grows with distance, not volume.
+  // maxDistance is clamped to RAYCAST_DISTANCE_LIMIT; zero, negative or NaN
+  // hits nothing.
+  WorldRayHit GetRayCollision(Ray ray,
+                              float maxDistance = RAYCAST_MAX_DISTANCE);
+
+  struct BoxMove {
+    Vector3 delta;         // Motion actually applied
+    bool hitX, hitY, hitZ; // Axes stopped by a solid block
+    int blocksTested;      // GetBlock lookups it took
+  };
+
+  // Moves an axis-aligned box by `motion` through the grid, X, then Z, then
+  // Y, sliding along whatever stops an axis. Each axis sweeps the layers of
+  // cells its leading face enters, nearest first, and stops COLLISION_SKIN
+  // short of the first solid one (Block::IsSolid), so the result is exact at
+  // any speed and a move that crosses no cell boundary tests no blocks.
+  // Cells the box already overlaps are ignored, so a box stuck in a block
+  // can move out. For any moving body; unloaded columns are open air.
+  BoxMove MoveBox(BoundingBox box, Vector3 motion);
 
 private:
-  void GenerateTerrain();
-  void GenerateTree(int x, int y, int z);
-  void RebuildChunk(int cx, int cy, int cz);
+  // Snapshot in, packed vertices out. Pooled and reused between rebuilds.
+  struct MeshJob {
+    ChunkSnapshot snapshot;
+    ChunkMeshData mesh;
+    MeshingMode mode;
+  };
+
+  // Packs a column position into a map key
+  struct ColumnKeyHash {
+    size_t operator()(uint64_t key) const {
+      key ^= key >> 33; // Mix so neighbouring columns spread across buckets
+      key *= 0xFF51AFD7ED558CCDULL;
+      return (size_t)(key ^ (key >> 33));
+    }
+  };
+  static uint64_t ColumnKey(int cx, int cz) {
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cz;
+  }
+
+  void LoadRenderResources();
+  // A chunk's blocks, decoded first if it came from a mapped save
+  ChunkSection &Blocks(Chunk &chunk) {
+    if (chunk.encoded)
+      DecodeChunk(chunk);
+    return chunk.blocks;
+  }
+  void DecodeChunk(Chunk &chunk);
+  ChunkColumn *FindColumn(int cx, int cz);
+  Chunk *FindChunk(int cx, int cy, int cz);
+  bool IsNeighbourhoodReady(int cx, int cz); // The column and its 8 around
+  ChunkColumn *AcquireColumn(int cx, int cz);
+  void EvictColumn(ChunkColumn *column);
+  void GenerateColumn(ChunkColumn &column);
+  void SubmitColumn(ChunkColumn *column); // Terrain job on the workers
+  void LoadOrGenerateColumn(ChunkColumn &column);
+  bool DecodeColumn(ChunkColumn &column, const uint8_t *data, size_t size,
+                    bool lazy);
+  void EncodeColumn(const ChunkColumn &column, std::vector<uint8_t> &record);
+  uint8_t ReadySides(const ChunkColumn &column); // For joinedSides
+  void ReleaseColumn(ChunkColumn *column); // Back to the free list
+  void CollectSavedColumns();
+  void WriteAutosave(int count, double snapshotMs); // I/O thread
+  int CollectGeneratedColumns(bool wait); // Columns that landed
+  void LandColumn(ChunkColumn *column);
+  void DecorateColumns();
+  void DecorateColumn(ChunkColumn &column);
+  void PlaceTree(ChunkColumn &column, int ox, int oz, const TreeSite &tree);
+
+  // Lighting. A queued cell, in block coordinates; level is the light it had
+  // for the removal queue, and 1 for a changed cell that got clearer.
+  struct LightNode {
+    int x, y, z;
+    int level;
+  };
+  static LightSection &Light(Chunk &chunk, int channel) {
+    return channel == LIGHT_SKY ? chunk.skyLight : chunk.blockLight;
+  }
+  void LightColumn(ChunkColumn &column); // On its own, any thread
+  void JoinColumnLight(ChunkColumn &column);
+  bool IsLightSupported(Chunk &chunk, int channel, int x, int y, int z,
+                        int level);
+  void JoinQueuedLight();
+  Chunk *FindLitChunk(int x, int y, int z);
+  bool QueueRelight(int x, int y, int z, BlockType before, BlockType after);
+  void RelightQueued(bool edited);
+  void RelightFilledBox(int x0, int y0, int z0, int x1, int y1, int z1,
+                        BlockType type); // Air or opaque, lit from its faces
+  int SpreadLight(int channel, bool edited);   // Returns cells visited
+  int UnspreadLight(int channel, bool edited); // Same
+  void MarkLightChanged(Chunk &chunk, int x, int y, int z, bool edited);
+  void FlushLightChanges(bool edited);
+
+  // Water. A cell in block coordinates.
+  struct WaterCell {
+    int x, y, z;
+  };
+  void WakeWater(int x, int y, int z); // Only if water is at or beside it
+  BlockType FlowWater(int x, int y, int z, BlockType type); // Next type
+  void RebuildChunk(int cx, int cy, int cz); // Snapshot + queue for meshing
+  void SnapshotChunk(int cx, int cy, int cz, ChunkSnapshot &snapshot);
+  void UploadChunkMesh(const ChunkMeshData &data);
+  void UnloadChunkMesh(Chunk &chunk);
+  void UploadFinishedMeshes();
+  ChunkWindow GetChunkWindow(Vector3 playerPos);
+  void MarkEdited(int cx, int cy, int cz);
+  void MarkEditedBox(int x0, int y0, int z0, int x1, int y1, int z1);
+  void WalkVisibleChunks(const Frustum &frustum, const ChunkWindow &window);
+  MeshJob *AcquireMeshJob();
 
   // Textures
-  Texture2D blockTextures[10];
+  // One per type up to the flowing water levels, which use BLOCK_WATER's
+  Texture2D blockTextures[BLOCK_WATER_FLOW];
   Texture2D atlasTexture; // Combined texture for chunks
+  Shader chunkShader;     // Decodes packed chunk vertices
+  int chunkOriginLoc;
+  unsigned int quadIndexBuffer; // 0,1,2, 0,2,3 pattern shared by all chunks
 
   // Helper to check if a block is hidden (surrounded by solids)
   bool IsBlockHidden(int x, int y, int z);
 
-  Block grid[WORLD_WIDTH][WORLD_HEIGHT][WORLD_DEPTH];
-  Chunk chunks[WORLD_WIDTH / CHUNK_SIZE][WORLD_HEIGHT / CHUNK_SIZE]
-              [WORLD_DEPTH / CHUNK_SIZE];
+  // Loaded columns. Evicted ones keep their (emptied) storage for reuse, so
+  // memory follows the render distance, not how far the player has walked.
+  std::unordered_map<uint64_t, ChunkColumn *, ColumnKeyHash> columns;
+  std::vector<ChunkColumn *> freeColumns;
+  ChunkColumn *lastColumn; // Last FindColumn hit, main thread only
+  struct ColumnCandidate {
+    int distance; // Squared, in columns from the player's
+    int cx, cz;
+  };
+  std::vector<ColumnCandidate> generateQueue; // Missing columns in range
+  std::vector<ChunkColumn *> evictQueue;
+  struct EditedChunk {
+    Chunk *chunk;
+    ChunkCoord coord;
+  };
+  std::vector<EditedChunk> editedChunks;   // ApplyEdits, in first-touch order
+  std::vector<LightNode> relightCells;     // Changed by the current edit
+  std::vector<LightNode> lightAddQueue;    // Cells to spread light from
+  std::vector<LightNode> lightRemoveQueue; // Cells whose light went out
+  std::vector<uint8_t> boxShafts;          // Per x, z: full sky above a box
+  std::vector<EditedChunk> litChunks;      // Noted by MarkLightChanged
+  int relightCellCount;
+  int columnsGenerated;
+  int columnsRead;
+  uint32_t seed;
+  std::mutex generateMutex;
+  std::condition_variable generateDone;       // Headless waits on it
+  std::vector<ChunkColumn *> generateResults; // Terrain done, not collected
+  int generateJobsInFlight;                   // Main thread only
+  std::vector<ChunkColumn *> decorateQueue;
+  int decorateJobsLeft; // Headless batch, under generateMutex
+  // READY since the last DecorateColumns, light not joined across borders
+  std::vector<ChunkColumn *> joinQueue;
+
+  bool headless;
+  int renderDistance;
+  std::vector<ChunkCoord> visibleChunks; // Drawn last frame
+  int candidateChunks;
+
+  // Occlusion culling walk, reused every frame
+  struct ChunkVisit {
+    ChunkCoord coord;
+    int8_t entryFace; // Face it was entered through, -1 for the start chunk
+    uint8_t steps;    // Directions taken so far, one bit per ChunkFace
+  };
+  bool occlusionCulling;
+  std::vector<ChunkVisit> visitQueue;
+  std::vector<uint8_t> visited; // Per chunk in the render window
+
+  // Rebuild order, refilled every Update
+  struct RebuildCandidate {
+    float priority; // Lower goes first
+    ChunkCoord coord;
+  };
+  std::vector<RebuildCandidate> rebuildQueue;
+  Frustum lastFrustum; // From the last CollectVisibleChunks, for the bias
+  bool hasLastFrustum;
+
+  // Background terrain generation and meshing share the workers
+  ThreadPool workerPool;
+
+  // Save, written by one I/O thread so writes never queue behind meshing
+  RegionStore regionStore;
+  ThreadPool ioPool;
+  std::mutex saveMutex;
+  std::vector<ChunkColumn *> savedColumns; // Written, not released yet
+  std::vector<uint8_t> saveRecord;         // I/O thread scratch
+  // Autosave copies: ChunkColumns holding blocks, light and trees only.
+  // Owned by the I/O thread while autosaving is set, the main thread
+  // otherwise.
+  std::vector<ChunkColumn *> snapshots;
+  std::atomic<bool> autosaving; // Also holds off eviction, see StreamColumns
+  double lastAutosaveTime;
+  SaveStats lastSave; // Under saveMutex
+
+  // Water: blocks changed near water since the last tick, then the cells
+  // that may change because of them, oldest first (keys in waterQueued)
+  std::vector<WaterCell> waterWake;
+  std::vector<WaterCell> waterActive;
+  size_t waterActiveHead; // waterActive before it were ticked already
+  std::unordered_set<uint64_t, ColumnKeyHash> waterQueued;
+  std::vector<BlockEdit> waterEdits; // One tick's changes
+  double lastWaterTime;
+  WaterStats lastWaterTick;
+
+  MeshingMode meshingMode;
+  std::mutex meshResultMutex;
+  std::vector<MeshJob *> meshResults;    // Built, oldest first
+  std::vector<MeshJob *> meshJobStorage; // Every job ever created
+  std::vector<MeshJob *> freeMeshJobs;   // Main thread only
+  int meshJobsInFlight;                  // Main thread only
+  int meshAllocations;
 };